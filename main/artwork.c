@@ -4,6 +4,8 @@
 static const char *TAG = "artwork";
 
 particle_t *particles;
+// Number of live particles.
+static size_t num_particles;
 
 static const variant_t variants[] = {
     { // Green poles.
@@ -27,52 +29,75 @@ int random_variant(int not_this) {
     // Max is one less than number of variants if one is skipped.
     uint64_t max = (not_this == -1) ? (num_variants) : (num_variants - 1);
     // Get a number in said range.
-    int nombre = (esp_random() * max) >> 32;
+    int nombre = (game_random() * max) >> 32;
     // Skip the excluded number.
     if (not_this != -1 && nombre >= not_this) nombre ++;
     return nombre;
 }
 
+// Gets the colour of a pole variant.
+pax_col_t variant_color(int variant) {
+    if (variant >= 0 && variant < num_variants) {
+        return variants[variant].color;
+    }
+    return 0xff00ff00;
+}
+
 // Draws the pole in the right place.
-void draw_pole(bard_t *bard, pole_t *pole) {
+void draw_pole(pax_buf_t *gfx, bard_t *bard, pole_t *pole) {
     // Find relative position.
     float x   = pole->x - bard->level_pos;
     float y   = pole->y;
     float gap = pole->gap;
     
     // Draw.
-    pax_col_t col = 0xff00ff00;
-    if (pole->variant >= 0 && pole->variant < num_variants) {
-        col = variants[pole->variant].color;
-    }
-    pax_draw_rect(&buf, col, x, 0, POLE_WIDTH, y - gap);
-    pax_draw_rect(&buf, col, x, y, POLE_WIDTH, buf.height - y - 30);
+    pax_col_t col = variant_color(pole->variant);
+    pax_draw_rect(gfx, col, x, 0, POLE_WIDTH, y - gap);
+    pax_draw_rect(gfx, col, x, y, POLE_WIDTH, SCREEN_HEIGHT - y - GROUND_HEIGHT);
     
-    // Hitbox visualisation.
-    x -= bard->x;
+    // Hitbox visualisation, collisions match the drawn poles exactly.
     if (SHOW_HITBOXES(bard)) {
-        x += bard->x;
-        pax_outline_rect(&buf, -1, x+POLE_LENIENCE, 0, POLE_WIDTH-POLE_LENIENCE*2, y - gap - POLE_LENIENCE);
-        pax_outline_rect(&buf, -1, x+POLE_LENIENCE, y+POLE_LENIENCE, POLE_WIDTH-POLE_LENIENCE*2, buf.height - y - 30 - POLE_LENIENCE);
+        pax_outline_rect(gfx, -1, x, 0, POLE_WIDTH, y - gap);
+        pax_outline_rect(gfx, -1, x, y, POLE_WIDTH, SCREEN_HEIGHT - y - GROUND_HEIGHT);
     }
 }
 
 // Draws the bard.
-void draw_bard(bard_t *bard) {
-    pax_push_2d(&buf);
-    pax_apply_2d(&buf, matrix_2d_translate(bard->x, bard->y));
-    pax_apply_2d(&buf, matrix_2d_rotate(bard->angle));
-    pax_draw_rect(&buf, 0xffff0000, -15, -15, 30, 30);
-    pax_pop_2d(&buf);
+void draw_bard(pax_buf_t *gfx, bard_t *bard) {
+    pax_push_2d(gfx);
+    pax_apply_2d(gfx, matrix_2d_translate(bard->x, bard->y));
+    if (quality()->rotate_bard) {
+        pax_apply_2d(gfx, matrix_2d_rotate(bard->angle));
+    }
+    pax_draw_rect(gfx, 0xffff0000, -15, -15, 30, 30);
+    pax_pop_2d(gfx);
     if (SHOW_HITBOXES(bard)) {
-        pax_outline_rect(&buf, -1, bard->x-HITBOX_RADIUS, bard->y-HITBOX_RADIUS, HITBOX_RADIUS*2, HITBOX_RADIUS*2);
+        int x, y, width, height;
+        collision_bounds(bard, &x, &y, &width, &height);
+        pax_outline_rect(gfx, -1, x, y, width, height);
+    }
+}
+
+// Draws the best run's ghost, a see-through bard.
+void draw_ghost(pax_buf_t *gfx, float y, float angle) {
+    pax_push_2d(gfx);
+    pax_apply_2d(gfx, matrix_2d_translate(BARD_X, y));
+    if (quality()->rotate_bard) {
+        pax_apply_2d(gfx, matrix_2d_rotate(angle));
     }
+    pax_draw_rect(gfx, 0x60ff0000, -15, -15, 30, 30);
+    pax_pop_2d(gfx);
 }
 
 // Draws the background.
-void draw_background() {
-    pax_background(&buf, 0xff00e0f0);
-    pax_simple_rect(&buf, 0xff009000, 0, buf.height-30, buf.width, 30);
+void draw_background(pax_buf_t *gfx) {
+    pax_background(gfx, 0xff00e0f0);
+}
+
+// Draws the ground.
+void draw_ground(pax_buf_t *gfx) {
+    // Drawn transformed so that it lands correctly inside of bands.
+    pax_draw_rect(gfx, 0xff009000, 0, SCREEN_HEIGHT-GROUND_HEIGHT, SCREEN_WIDTH, GROUND_HEIGHT);
 }
 
 
@@ -89,12 +114,16 @@ static void particle_delete(particle_t *part) {
         part->next->prev = part->prev;
     }
     // Free memory.
-    free(part);
+    mem_free(part);
+    num_particles --;
 }
 
 // Apply physics to all particles.
 void render_particles(bard_t *bard) {
-    for (particle_t *cur = particles; cur; cur = cur->next) {
+    int age_step = particle_age_step();
+    particle_t *next;
+    for (particle_t *cur = particles; cur; cur = next) {
+        next = cur->next;
         // Apply velocity.
         cur->x += cur->vx;
         cur->y += cur->vy;
@@ -105,24 +134,35 @@ void render_particles(bard_t *bard) {
         cur->vx *= 1 - cur->drag;
         cur->vy *= 1 - cur->drag;
         // Like a fine wine.
-        cur->age ++;
+        cur->age += age_step;
+        // Gone.
+        if (cur->age > cur->lifespan) {
+            particle_delete(cur);
+        }
     }
 }
 
 // Draws all particles.
-void draw_particles(bard_t *bard) {
-    for (particle_t *cur = particles; cur; cur = cur->next) {
-        pax_push_2d(&buf);
-        pax_apply_2d(&buf, matrix_2d_translate(cur->x - bard->level_pos, cur->y));
+void draw_particles(pax_buf_t *gfx, bard_t *bard, const particle_t *parts, size_t num) {
+    bool simple = particle_lod() >= PARTICLE_LOD_SIMPLE;
+    for (size_t i = 0; i < num; i++) {
+        const particle_t *cur = &parts[i];
+        pax_push_2d(gfx);
+        pax_apply_2d(gfx, matrix_2d_translate(cur->x - bard->level_pos, cur->y));
         
-        pax_buf_t *rsrc = resource_get(cur->filename);
-        if (rsrc) {
+        pax_buf_t *rsrc = simple ? NULL : resource_get(cur->filename);
+        if (simple) {
+            // Plain squares when detail is lowered.
+            float part = cur->age > cur->lifespan ? 0 : (cur->lifespan - cur->age) / (float) cur->lifespan;
+            pax_col_t col = ((pax_col_t) (0xff * part) << 24) | (cur->color & 0x00ffffff);
+            if (part) pax_draw_rect(gfx, col, -2, -2, 4, 4);
+        } else if (rsrc) {
             float part = cur->age > cur->lifespan ? 0 : (cur->lifespan - cur->age) / (float) cur->lifespan;
             if (part) {
                 pax_col_t tint = (pax_col_t) (0xff000000 * part) | 0x00ffffff;
                 // tint = pax_col_tint(cur->color, tint);
                 pax_shade_rect(
-                    &buf, tint,
+                    gfx, tint,
                     &PAX_SHADER_TEXTURE(rsrc), NULL, 
                     -rsrc->width/2, -rsrc->height/2,
                     rsrc->width,    rsrc->height
@@ -130,10 +170,32 @@ void draw_particles(bard_t *bard) {
             }
         }
         
-        pax_pop_2d(&buf);
+        pax_pop_2d(gfx);
     }
 }
 
+// Gets the range of screen rows covered by particles.
+void particle_bounds(const particle_t *parts, size_t num, int *top, int *bottom) {
+    float min = SCREEN_HEIGHT, max = 0;
+    for (size_t i = 0; i < num; i++) {
+        const particle_t *cur = &parts[i];
+        if (cur->y < min) min = cur->y;
+        if (cur->y > max) max = cur->y;
+    }
+    // Particle images are small, this margin covers them.
+    *top    = min - PARTICLE_MARGIN;
+    *bottom = max + PARTICLE_MARGIN;
+}
+
+// Copies up to max particles into an array, returns the number copied.
+size_t particle_snapshot(particle_t *out, size_t max) {
+    size_t num = 0;
+    for (particle_t *cur = particles; cur && num < max; cur = cur->next) {
+        out[num ++] = *cur;
+    }
+    return num;
+}
+
 // Delete all particles.
 void particle_clear() {
     while (particles) {
@@ -141,25 +203,60 @@ void particle_clear() {
     }
 }
 
+// Gets a random number from -1 to 1.
+static float random_unit() {
+    return ((int) esp_random()) / (float) INT32_MAX;
+}
+
 // Spawns a number of particles, spread around the original position.
 void particle_spread(particle_t type, size_t number, float spread_x, float spread_y, spread_t spreading) {
     bool repel = spreading & 1;
     spreading &= ~1;
+    float speed = 2.0f;
+    
+    // The cone points the way the particle type moves.
+    float cone_dir = atan2f(type.vy, type.vx);
+    if (spreading == SPREAD_CONE && (type.vx || type.vy)) {
+        speed = sqrtf(type.vx * type.vx + type.vy * type.vy);
+    }
     
-    // TODO: Other spread modes?
+    // Fewer particles when detail is lowered.
+    number = particle_lod_scale(number);
     
-    // Simple rectangle spread.
     for (size_t i = 0; i < number; i++) {
         particle_t part = type;
-        part.x += ((int) esp_random()) / (float) INT32_MAX * spread_x;
-        part.y += ((int) esp_random()) / (float) INT32_MAX * spread_y;
+        float dx, dy;
+        if (spreading == SPREAD_RADIAL) {
+            // Evenly in a circle with radius spread_x.
+            float angle = random_unit() * M_PI_F;
+            float dist  = sqrtf(fabsf(random_unit())) * spread_x;
+            dx = cosf(angle) * dist;
+            dy = sinf(angle) * dist;
+        } else if (spreading == SPREAD_CONE) {
+            // In a cone with length spread_x and half-angle spread_y.
+            float angle = cone_dir + random_unit() * spread_y;
+            float dist  = fabsf(random_unit()) * spread_x;
+            dx = cosf(angle) * dist;
+            dy = sinf(angle) * dist;
+        } else {
+            // Simple rectangle spread.
+            dx = random_unit() * spread_x;
+            dy = random_unit() * spread_y;
+        }
+        part.x += dx;
+        part.y += dy;
         
-        if (repel) {
-            float speed = 2.0;
+        if (repel && spreading == SPREAD_RECTANGULAR) {
             if (spread_x)
-                part.vx = (part.x - type.x) / spread_x * speed;
+                part.vx = dx / spread_x * speed;
             if (spread_y)
-                part.vy = (part.y - type.y) / spread_y * speed;
+                part.vy = dy / spread_y * speed;
+        } else if (repel) {
+            float dist = sqrtf(dx * dx + dy * dy);
+            if (dist) {
+                part.vx = dx / dist * speed;
+                part.vy = dy / dist * speed;
+            }
         }
         particle_add(part);
     }
@@ -167,11 +264,15 @@ void particle_spread(particle_t type, size_t number, float spread_x, float sprea
 
 // Adds one particle at the original position.
 void particle_add(particle_t part) {
+    // Particles are cosmetic, drop them when over budget.
+    if (num_particles >= particle_budget()) return;
+    // Allocate memory, or drop it if there is none.
+    particle_t *mem = mem_alloc(MEM_PARTICLES, sizeof(particle_t));
+    if (!mem) return;
+    num_particles ++;
     // Link it to the list.
     part.prev       = NULL;
     part.next       = particles;
-    // Allocate memory.
-    particle_t *mem = malloc(sizeof(particle_t));
     *mem            = part;
     if (particles) {
         particles->prev = mem;
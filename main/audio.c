@@ -0,0 +1,96 @@
+
+#include "audio.h"
+#include "mixer.h"
+#include "driver/i2s.h"
+#include "freertos/task.h"
+#include "esp_timer.h"
+
+static const char *TAG = "audio";
+
+extern const uint8_t sfx_jump_start[]  asm("_binary_jump_pcm_start");
+extern const uint8_t sfx_jump_end[]    asm("_binary_jump_pcm_end");
+extern const uint8_t sfx_score_start[] asm("_binary_score_pcm_start");
+extern const uint8_t sfx_score_end[]   asm("_binary_score_pcm_end");
+extern const uint8_t sfx_death_start[] asm("_binary_death_pcm_start");
+extern const uint8_t sfx_death_end[]   asm("_binary_death_pcm_end");
+
+// Start and end of each sound effect, 16-bit signed mono PCM.
+static const uint8_t *const sfx_data[SFX_COUNT][2] = {
+    [SFX_JUMP]  = { sfx_jump_start,  sfx_jump_end  },
+    [SFX_SCORE] = { sfx_score_start, sfx_score_end },
+    [SFX_DEATH] = { sfx_death_start, sfx_death_end },
+};
+
+// Bitmask of sound effects that have been triggered but not yet started.
+static _Atomic uint32_t pending;
+// Output block, interleaved stereo.
+static int16_t out[MIXER_BLOCK * 2];
+
+// Mixes audio forever, the I2S DMA buffers act as the ring buffer.
+static void audio_task(void *args) {
+    int64_t busy   = 0;
+    size_t  blocks = 0;
+    while (1) {
+        int64_t start = esp_timer_get_time();
+        
+        // Start newly triggered sounds.
+        uint32_t start_mask = atomic_exchange(&pending, 0);
+        for (sfx_t i = 0; i < SFX_COUNT; i++) {
+            if (start_mask & (1 << i)) {
+                mixer_start((const int16_t *) sfx_data[i][0], (const int16_t *) sfx_data[i][1]);
+            }
+        }
+        mixer_mix(out);
+        busy += esp_timer_get_time() - start;
+        
+        // Blocks until there is room in the DMA buffers.
+        size_t written;
+        i2s_write(I2S_NUM_0, out, sizeof(out), &written, portMAX_DELAY);
+        
+        // Report the share of real time spent mixing.
+        if (++ blocks >= AUDIO_REPORT) {
+            int64_t real = (int64_t) AUDIO_REPORT * MIXER_BLOCK * 1000000 / AUDIO_RATE;
+            ESP_LOGI(TAG, "Mixing took %lld us per block (%.2f%% CPU).",
+                busy / AUDIO_REPORT, busy * 100.0 / real);
+            busy   = 0;
+            blocks = 0;
+        }
+    }
+}
+
+// Starts the audio output and the mixing task.
+bool audio_init() {
+    i2s_config_t config = {
+        .mode                 = I2S_MODE_MASTER | I2S_MODE_TX,
+        .sample_rate          = AUDIO_RATE,
+        .bits_per_sample      = I2S_BITS_PER_SAMPLE_16BIT,
+        .channel_format       = I2S_CHANNEL_FMT_RIGHT_LEFT,
+        .communication_format = I2S_COMM_FORMAT_STAND_I2S,
+        .intr_alloc_flags     = 0,
+        .dma_buf_count        = 4,
+        .dma_buf_len          = MIXER_BLOCK,
+        .use_apll             = false,
+        .tx_desc_auto_clear   = true,
+    };
+    i2s_pin_config_t pins = {
+        .mck_io_num   = I2S_PIN_NO_CHANGE,
+        .bck_io_num   = GPIO_I2S_CLK,
+        .ws_io_num    = GPIO_I2S_LR,
+        .data_out_num = GPIO_I2S_DATA,
+        .data_in_num  = I2S_PIN_NO_CHANGE,
+    };
+    esp_err_t res = i2s_driver_install(I2S_NUM_0, &config, 0, NULL);
+    if (!res) res = i2s_set_pin(I2S_NUM_0, &pins);
+    if (res) {
+        ESP_LOGE(TAG, "Failed to start I2S: %s", esp_err_to_name(res));
+        return false;
+    }
+    
+    xTaskCreatePinnedToCore(audio_task, "audio", AUDIO_STACK, NULL, configMAX_PRIORITIES - 2, NULL, AUDIO_CORE);
+    return true;
+}
+
+// Starts playing a sound effect, safe to call from any task.
+void audio_play(sfx_t sfx) {
+    atomic_fetch_or(&pending, 1 << sfx);
+}
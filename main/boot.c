@@ -0,0 +1,82 @@
+
+#include "boot.h"
+#include "esp_timer.h"
+#include "string.h"
+#include "freertos/task.h"
+
+static const char *TAG = "boot";
+
+typedef struct boot_phase boot_phase_t;
+
+struct boot_phase {
+    // Name of the phase.
+    const char *name;
+    // Time at which the phase finished, in microseconds since boot.
+    int64_t     time;
+    // Core that ran the phase.
+    int         core;
+};
+
+// Recorded boot phases, in order of completion.
+static boot_phase_t phases[BOOT_MAX_PHASES];
+// Number of recorded boot phases.
+static size_t       num_phases;
+// Whether the first frame has been reported, later phases are logged as they finish.
+static bool         reported;
+// Time at which the last reported phase on each core finished.
+static int64_t      last_time[2];
+// Phases are recorded from both cores.
+static portMUX_TYPE phase_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// Logs a finished phase, with how long it took since the previous one on the same core.
+static void boot_log(const boot_phase_t *phase, int64_t prev) {
+    ESP_LOGI(TAG, "%-10s core %d done at %6lld us (took %6lld us)",
+        phase->name, phase->core, (long long) phase->time, (long long) (phase->time - prev)
+    );
+}
+
+// Records that a boot phase has just finished.
+void boot_mark(const char *phase) {
+    boot_phase_t cur = {
+        .name = phase,
+        .time = esp_timer_get_time(),
+        .core = xPortGetCoreID(),
+    };
+    portENTER_CRITICAL(&phase_lock);
+    if (num_phases < BOOT_MAX_PHASES) {
+        phases[num_phases ++] = cur;
+    }
+    // Phases that finish after the first frame would never be seen otherwise.
+    bool    late = reported;
+    int64_t prev = last_time[cur.core & 1];
+    if (late) last_time[cur.core & 1] = cur.time;
+    portEXIT_CRITICAL(&phase_lock);
+    
+    // Logging can block, so it happens outside of the lock.
+    if (late) boot_log(&cur, prev);
+}
+
+// Reports the boot phases the first time a frame reaches the screen, later phases are logged as they finish.
+void boot_first_frame() {
+    if (reported) return;
+    int64_t now = esp_timer_get_time();
+    
+    // Background phases may still be running, report what has finished and log the rest as they do.
+    portENTER_CRITICAL(&phase_lock);
+    boot_phase_t copy[BOOT_MAX_PHASES];
+    size_t num = num_phases;
+    memcpy(copy, phases, sizeof(phases));
+    for (size_t i = 0; i < num; i++) {
+        last_time[copy[i].core & 1] = copy[i].time;
+    }
+    reported = true;
+    portEXIT_CRITICAL(&phase_lock);
+    
+    // Phases on the same core run back to back.
+    int64_t last[2] = { 0, 0 };
+    for (size_t i = 0; i < num; i++) {
+        boot_log(&copy[i], last[copy[i].core & 1]);
+        last[copy[i].core & 1] = copy[i].time;
+    }
+    ESP_LOGI(TAG, "First frame at %lld us after boot.", (long long) now);
+}
@@ -0,0 +1,126 @@
+
+#include "collision.h"
+#include "esp_timer.h"
+
+static const char *TAG = "collision";
+
+typedef struct coll_mask coll_mask_t;
+
+struct coll_mask {
+    // One bit per pixel, bit 0 is the leftmost column.
+    uint64_t rows[COLL_SIZE];
+    // First row with any bits set.
+    uint8_t  first;
+    // Row after the last row with any bits set.
+    uint8_t  last;
+    // Leftmost column with a bit set.
+    uint8_t  left;
+    // Column after the rightmost column with a bit set.
+    uint8_t  right;
+};
+
+// The bard's masks, one per rotation step.
+static coll_mask_t bard_masks[COLL_STEPS];
+// Whether the masks have been built.
+static bool        coll_ready;
+
+// Builds the bard's collision masks, does nothing if already built.
+void collision_init() {
+    if (coll_ready) return;
+    int64_t start = esp_timer_get_time();
+    
+    for (int step = 0; step < COLL_STEPS; step++) {
+        coll_mask_t *mask = &bard_masks[step];
+        float angle = step * (M_PI_F / 2) / COLL_STEPS;
+        float c = cosf(angle), s = sinf(angle);
+        mask->first = COLL_SIZE;
+        mask->last  = 0;
+        mask->left  = COLL_SIZE;
+        mask->right = 0;
+        
+        for (int y = 0; y < COLL_SIZE; y++) {
+            uint64_t row = 0;
+            for (int x = 0; x < COLL_SIZE; x++) {
+                // Rotate the pixel's center back into the bard's own space.
+                float px = x + 0.5f - COLL_RADIUS;
+                float py = y + 0.5f - COLL_RADIUS;
+                float u  =  c * px + s * py;
+                float v  = -s * px + c * py;
+                if (fabsf(u) <= HITBOX_RADIUS && fabsf(v) <= HITBOX_RADIUS) {
+                    row |= 1ULL << x;
+                    if (x < mask->left)   mask->left  = x;
+                    if (x >= mask->right) mask->right = x + 1;
+                }
+            }
+            mask->rows[y] = row;
+            if (row && y < mask->first) mask->first = y;
+            if (row) mask->last = y + 1;
+        }
+    }
+    
+    coll_ready = true;
+    ESP_LOGI(TAG, "Built %d masks in %lld us.", COLL_STEPS, (long long) (esp_timer_get_time() - start));
+}
+
+// Gets the mask for the bard's current angle.
+static const coll_mask_t *collision_mask(const bard_t *bard) {
+    // Quality only changes how the bard is drawn, the game plays the same at every tier.
+    // A square looks the same every quarter turn.
+    int step = lroundf(bard->angle * COLL_STEPS / (M_PI_F / 2)) % COLL_STEPS;
+    if (step < 0) step += COLL_STEPS;
+    return &bard_masks[step];
+}
+
+// Gets a mask with the columns [from, to) set, clipped to 64 columns.
+static inline uint64_t collision_columns(int from, int to) {
+    if (from < 0)  from = 0;
+    if (to   > 64) to   = 64;
+    if (from >= to) return 0;
+    uint64_t upto = to == 64 ? ~0ULL : (1ULL << to) - 1;
+    return upto & ~((1ULL << from) - 1);
+}
+
+// Tests the bard against a pole, returns a combination of COLL_TOP and COLL_BOTTOM.
+int collision_pole(const bard_t *bard, const pole_t *pole) {
+    const coll_mask_t *mask = collision_mask(bard);
+    int left = lroundf(bard->x) - COLL_RADIUS;
+    int top  = lroundf(bard->y) - COLL_RADIUS;
+    
+    // Which of the mask's columns the pole covers.
+    int      pole_x  = floorf(pole->x - bard->level_pos);
+    uint64_t columns = collision_columns(pole_x - left, pole_x + POLE_WIDTH - left);
+    if (!columns) return 0;
+    
+    // Which of the mask's rows the gap covers.
+    int gap_top    = ceilf(pole->y - pole->gap - 0.5f) - top;
+    int gap_bottom = ceilf(pole->y - 0.5f) - top;
+    
+    int hits = 0;
+    for (int y = mask->first; y < mask->last && y < gap_top; y++) {
+        if (mask->rows[y] & columns) {
+            hits |= COLL_TOP;
+            break;
+        }
+    }
+    for (int y = mask->last - 1; y >= mask->first && y >= gap_bottom; y--) {
+        if (mask->rows[y] & columns) {
+            hits |= COLL_BOTTOM;
+            break;
+        }
+    }
+    return hits;
+}
+
+// Gets the screen rectangle around the bard's current mask.
+void collision_bounds(const bard_t *bard, int *x, int *y, int *width, int *height) {
+    const coll_mask_t *mask = collision_mask(bard);
+    *x      = lroundf(bard->x) - COLL_RADIUS + mask->left;
+    *y      = lroundf(bard->y) - COLL_RADIUS + mask->first;
+    *width  = mask->right - mask->left;
+    *height = mask->last - mask->first;
+}
+
+// Gets how far the bard's current mask reaches right of its center, in whole pixels.
+int collision_right(const bard_t *bard) {
+    return collision_mask(bard)->right - COLL_RADIUS;
+}
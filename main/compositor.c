@@ -0,0 +1,82 @@
+
+#include "compositor.h"
+#include "ili9341.h"
+#include "esp_heap_caps.h"
+#include "mem.h"
+
+static const char *TAG = "compositor";
+
+// Layers in the current scene, in drawing order.
+static layer_t layers[MAX_LAYERS];
+// Number of layers in the current scene.
+static size_t  num_layers;
+// Buffer that holds a single band.
+static pax_buf_t band;
+// Whether the band buffer has been allocated.
+static bool    band_ready;
+
+// Allocates the band buffer.
+bool comp_init() {
+    if (band_ready) return true;
+    
+    // Keep the band in internal RAM so drawing and DMA stay off PSRAM.
+    void *mem = mem_alloc_caps(
+        MEM_FRAMEBUFFER, SCREEN_WIDTH * BAND_HEIGHT * sizeof(uint16_t),
+        MALLOC_CAP_INTERNAL | MALLOC_CAP_DMA
+    );
+    if (!mem) return false;
+    pax_buf_init(&band, mem, SCREEN_WIDTH, BAND_HEIGHT, PAX_BUF_16_565RGB);
+    band_ready = true;
+    return true;
+}
+
+// Removes all layers from the scene.
+void comp_clear() {
+    num_layers = 0;
+}
+
+// Adds a layer to the scene, covering the screen rows [top, bottom).
+void comp_add(int top, int bottom, layer_draw_t draw, const void *ctx, const void *args) {
+    // Clip to the screen.
+    if (top < 0) top = 0;
+    if (bottom > SCREEN_HEIGHT) bottom = SCREEN_HEIGHT;
+    if (top >= bottom) return;
+    
+    if (num_layers >= MAX_LAYERS) {
+        ESP_LOGW(TAG, "Too many layers, dropping one.");
+        return;
+    }
+    layers[num_layers ++] = (layer_t) {
+        .top    = top,
+        .bottom = bottom,
+        .draw   = draw,
+        .ctx    = ctx,
+        .args   = args,
+    };
+}
+
+// Draws all layers that intersect the rows [top, bottom) into gfx.
+static void comp_draw_rows(pax_buf_t *gfx, int top, int bottom) {
+    pax_reset_2d(gfx, PAX_RESET_ALL);
+    pax_apply_2d(gfx, matrix_2d_translate(0, -top));
+    for (size_t i = 0; i < num_layers; i++) {
+        if (layers[i].top < bottom && layers[i].bottom > top) {
+            layers[i].draw(gfx, &layers[i]);
+        }
+    }
+    pax_join();
+}
+
+// Renders the scene band by band and sends each band to the screen.
+void comp_flush() {
+    if (!band_ready) return;
+    for (int top = 0; top < SCREEN_HEIGHT; top += BAND_HEIGHT) {
+        comp_draw_rows(&band, top, top + BAND_HEIGHT);
+        ili9341_write_partial_direct(get_ili9341(), band.buf, 0, top, SCREEN_WIDTH, BAND_HEIGHT);
+    }
+}
+
+// Renders the entire scene into a full-size buffer.
+void comp_render(pax_buf_t *target) {
+    comp_draw_rows(target, 0, target->height);
+}
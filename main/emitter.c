@@ -0,0 +1,87 @@
+
+#include "emitter.h"
+#include "artwork.h"
+
+static const char *TAG = "emitter";
+
+// All emitters, inactive ones are free to use.
+static emitter_t    emitters[MAX_EMITTERS];
+
+// Adds a continuous emitter, spawning rate particles per frame of the given type.
+emitter_t *emitter_add(particle_t type, float rate, float spread_x, float spread_y, spread_t spreading) {
+    for (size_t i = 0; i < MAX_EMITTERS; i++) {
+        if (!emitters[i].active) {
+            emitters[i] = (emitter_t) {
+                .type      = type,
+                .rate      = rate,
+                .pending   = 0,
+                .spread_x  = spread_x,
+                .spread_y  = spread_y,
+                .spreading = spreading,
+                .active    = true,
+            };
+            return &emitters[i];
+        }
+    }
+    ESP_LOGW(TAG, "Out of emitters.");
+    return NULL;
+}
+
+// Moves an emitter to a new position in the level.
+void emitter_move(emitter_t *emitter, float x, float y) {
+    if (!emitter) return;
+    emitter->type.x = x;
+    emitter->type.y = y;
+}
+
+// Removes an emitter, its particles live on.
+void emitter_remove(emitter_t *emitter) {
+    if (emitter) emitter->active = false;
+}
+
+// Removes all emitters.
+void emitter_clear() {
+    for (size_t i = 0; i < MAX_EMITTERS; i++) {
+        emitters[i].active = false;
+    }
+}
+
+// Spawns particles from all emitters.
+void render_emitters() {
+    for (size_t i = 0; i < MAX_EMITTERS; i++) {
+        emitter_t *cur = &emitters[i];
+        if (!cur->active) continue;
+        // Keep fractional particles for the next frame.
+        cur->pending += cur->rate;
+        size_t number = cur->pending;
+        cur->pending -= number;
+        if (number) {
+            particle_spread(cur->type, number, cur->spread_x, cur->spread_y, cur->spreading);
+        }
+    }
+}
+
+
+// Gets the current particle detail level.
+int particle_lod() {
+    // The quality governor owns the frame budget, particle detail follows its tier.
+    return quality()->particle_lod;
+}
+
+// Gets the maximum number of live particles at the current detail level.
+size_t particle_budget() {
+    if (!quality()->particles) return 0;
+    return PARTICLE_BUDGET >> particle_lod();
+}
+
+// Scales a number of particles to spawn to the current detail level.
+size_t particle_lod_scale(size_t number) {
+    size_t scaled = number >> particle_lod();
+    // Keep at least one so effects don't vanish entirely.
+    return scaled || !number ? scaled : 1;
+}
+
+// Gets how many frames particles age per update at the current detail level.
+int particle_age_step() {
+    return particle_lod() >= PARTICLE_LOD_SIMPLE ? 2 : 1;
+}
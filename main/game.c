@@ -0,0 +1,362 @@
+
+#include "game.h"
+
+static const char *TAG = "game";
+
+// Frames shared between the simulation and the renderer.
+static frame_t          frames[3];
+// Index of the frame that is neither being written nor read, with FRAME_FRESH if it is new.
+static _Atomic uint32_t shared_frame;
+// Index of the frame being written by the simulation.
+static uint32_t         back_frame;
+// Index of the frame being read by the renderer.
+static uint32_t         front_frame;
+// The simulation task.
+static TaskHandle_t     sim_task;
+// The render task.
+static TaskHandle_t     render_task;
+// State of the game's random number generator.
+static uint32_t         rng_state;
+
+// Gets a random number from the game's own generator, which can be saved.
+uint32_t game_random() {
+    // Xorshift32.
+    uint32_t x = rng_state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    rng_state = x;
+    return x;
+}
+
+// Gets the frame that the simulation is writing.
+static frame_t *game_back() {
+    return &frames[back_frame];
+}
+
+// Publishes the frame the simulation wrote, taking the shared one in return.
+static void game_publish() {
+    back_frame = atomic_exchange(&shared_frame, back_frame | FRAME_FRESH) & FRAME_INDEX;
+    xTaskNotifyGive(render_task);
+}
+
+// Copies the game state into a frame.
+static void game_snapshot(frame_t *frame, bard_t *bard, pole_t *poles) {
+    frame->finished  = false;
+    frame->suspended = false;
+    frame->bard      = *bard;
+    frame->num_poles = 0;
+    for (pole_t *cur = poles; cur && frame->num_poles < MAX_FRAME_POLES; cur = cur->next) {
+        frame->poles[frame->num_poles ++] = *cur;
+    }
+    frame->num_particles = particle_snapshot(frame->particles, MAX_FRAME_PARTICLES);
+}
+
+
+
+// Ends the game, telling the renderer and deleting the simulation task.
+static void game_finish(pole_t *poles, bool suspended) {
+    // Delete the linked list.
+    while (poles) {
+        void *mem = poles;
+        poles = poles->next;
+        mem_free(mem);
+    }
+    particle_clear();
+    emitter_clear();
+    ghost_finish(false);
+    led_event(LED_OFF, 0);
+    mem_report();
+    game_back()->finished  = true;
+    game_back()->suspended = suspended;
+    game_publish();
+    vTaskDelete(NULL);
+}
+
+// Sets up a new game, returns the initial pole or NULL when out of memory.
+static pole_t *game_new(bard_t *bard) {
+    // Seed the game's own random number generator.
+    do {
+        rng_state = esp_random();
+    } while (!rng_state);
+    
+    // Set initial position equal to main menu.
+    uint64_t now       = esp_timer_get_time() / 1000;
+    bard->x            = BARD_X;
+    bard->y            = 50 + sinf(now * M_PI_F / 2000) * 10;
+    bard->angle        = sinf(now * M_PI_F / 1000) * M_PI_F / 32;
+    // Start unpaused while jumping.
+    bard->vel          = JUMP_HEIGHT;
+    bard->paused       = false;
+    bard->alive        = true;
+    // Level position.
+    bard->level_pos    = 0;
+    bard->level_vel    = LEVEL_SPEED;
+    // Difficulty curves.
+    bard->diff_level   = 0;
+    bard->pole_dist    = diff_pole_dist[0];
+    bard->pole_gap     = diff_pole_gap[0];
+    bard->next_diff    = DIFF_INC_EVERY;
+    // Miscellaneous.
+    bard->pole_variant = random_variant(-1);
+    bard->score        = 0;
+    bard->num_poles    = 1;
+    
+    // Initial pole.
+    pole_t *poles = mem_alloc(MEM_POLES, sizeof(pole_t));
+    if (!poles) return NULL;
+    *poles = (pole_t) {
+        .prev      = NULL,
+        .next      = NULL,
+        .x         = 400,
+        .y         = 100,
+        .gap       = bard->pole_gap,
+        .variant   = bard->pole_variant,
+        .counted   = false,
+        .offscreen = false,
+        .onscreen  = false,
+    };
+    return poles;
+}
+
+// Simulates one game, publishing a frame after every step.
+static void game_task(void *args) {
+    bool     resume    = args;
+    uint64_t exit_time = 0;
+    uint64_t now;
+    bard_t   bard;
+    pole_t  *poles     = NULL;
+    
+    particle_clear();
+    emitter_clear();
+    collision_init();
+    
+    // Continue a suspended game if asked, otherwise start a new one.
+    if (resume) {
+        poles = save_load(&bard, &rng_state);
+    }
+    if (!poles) {
+        poles = game_new(&bard);
+        // A resumed game is out of step with the best run, so only new games get a ghost.
+        ghost_start();
+    }
+    if (!poles) {
+        ESP_LOGE(TAG, "Out of memory, can't start the game.");
+        game_finish(NULL, false);
+        return;
+    }
+    
+    // The LEDs pulse in the colour of the poles.
+    led_event(LED_VARIANT, variant_color(bard.pole_variant));
+    
+    // The best run's ghost.
+    bool  ghost = false;
+    float ghost_y, ghost_angle;
+    
+    // Dust trailing behind the bard.
+    emitter_t *trail = emitter_add(PARTICLE_TRAIL(0, 0), TRAIL_RATE, 2, 4, SPREAD_RECTANGULAR);
+    
+    while (1) {
+        // Get current time for reference.
+        now = esp_timer_get_time() / 1000;
+        
+        if (!bard.paused) {
+            // Apply physics.
+            bard.y   += bard.vel;
+            bard.vel += GRAVITY;
+            
+            // Maximum height.
+            if (bard.y < -40) {
+                bard.y = -40;
+            }
+            
+            // Minimum height.
+            if (bard.y > SCREEN_HEIGHT - GROUND_HEIGHT - HITBOX_RADIUS) {
+                bard.y = SCREEN_HEIGHT - GROUND_HEIGHT - HITBOX_RADIUS;
+                // Bounce off the floor.
+                bard.vel *= -0.5f;
+                bard.vel += GRAVITY*3;
+                if (bard.vel > 0) bard.vel = 0;
+                else {
+                    particle_spread(
+                        PARTICLE_DUST(bard.x + bard.level_pos, SCREEN_HEIGHT - GROUND_HEIGHT),
+                        10,
+                        10, 0, REPEL_RECTANGULAR
+                    );
+                }
+                // Game over.
+                if (bard.alive) {
+                    audio_play(SFX_DEATH);
+                    led_event(LED_DEATH, 0);
+                }
+                bard.alive = false;
+            }
+            
+            // Bard angle.
+            if (fabsf(bard.vel) >= 0.3f) {
+                float angle_target = M_PI_F / 6 * bard.vel / JUMP_HEIGHT + M_PI_F/12;
+                float angle_error  = angle_target - bard.angle;
+                bard.angle = angle_target - 0.7f * angle_error;
+            }
+            
+            // Level physics.
+            if (bard.alive) {
+                bard.level_pos += bard.level_vel;
+                
+                // Check whether a pole must be removed.
+                if (poles->offscreen && poles->next) {
+                    // Unlink it from the list.
+                    void *to_free = poles;
+                    poles->next->prev = NULL;
+                    poles = poles->next;
+                    mem_free(to_free);
+                }
+            }
+            
+            for (pole_t *cur = poles; cur; cur = cur->next) {
+                render_pole(&bard, cur);
+                
+                // Check whether a pole must be added.
+                if (!cur->next && cur->onscreen && bard.alive) {
+                    // Add the next pole.
+                    pole_t *next = mem_alloc(MEM_POLES, sizeof(pole_t));
+                    // Out of memory, try again next step.
+                    if (!next) continue;
+                    *next = (pole_t) {
+                        .prev      = cur,
+                        .next      = NULL,
+                        .x         = cur->x + POLE_WIDTH + bard.pole_dist,
+                        .gap       = bard.pole_gap,
+                        .variant   = bard.pole_variant,
+                        .counted   = false,
+                        .offscreen = false,
+                        .onscreen  = false,
+                    };
+                    // Randomise it's vertical position.
+                    next->y = game_random() / (float) UINT32_MAX;
+                    const float bottom = SCREEN_HEIGHT - GROUND_HEIGHT - POLE_LENIENCE * 2;
+                    const float top    = POLE_LENIENCE * 2 + next->gap;
+                    next->y = top + (bottom - top) * next->y;
+                    // Link it to the list.
+                    cur->next = next;
+                    // Keep track of number of poles added.
+                    bard.num_poles ++;
+                }
+            }
+            
+            // The trail stops when the bard dies.
+            if (trail && !bard.alive) {
+                emitter_remove(trail);
+                trail = NULL;
+            }
+            emitter_move(trail, bard.x + bard.level_pos - HITBOX_RADIUS, bard.y);
+            
+            // Particle physics.
+            render_emitters();
+            render_particles(&bard);
+            
+            // Ghost, which keeps its last position once the bard dies.
+            if (bard.alive) {
+                ghost_record(&bard);
+                ghost = ghost_next(&ghost_y, &ghost_angle);
+            }
+        }
+        
+        // Increasing difficulty.
+        if (bard.num_poles >= bard.next_diff) {
+            bard.next_diff += DIFF_INC_EVERY;
+            // The curve is precomputed, the last step is close enough to the minimum to repeat.
+            if (bard.diff_level < DIFF_STEPS - 1) bard.diff_level ++;
+            bard.pole_dist  = diff_pole_dist[bard.diff_level];
+            bard.pole_gap   = diff_pole_gap[bard.diff_level];
+            bard.pole_variant = random_variant(bard.pole_variant);
+            led_event(LED_VARIANT, variant_color(bard.pole_variant));
+        }
+        
+        // Game over delay.
+        if (!bard.alive) {
+            if (!exit_time && bard.vel == 0) {
+                // Set exit timer.
+                exit_time = esp_timer_get_time() / 1000 + EXIT_TIME;
+                // Update high score, the best run becomes the new ghost.
+                bool best = bard.score > get_hiscore();
+                if (best) set_hiscore(bard.score);
+                ghost_finish(best);
+                leaderboard_submit(bard.score);
+            } else if (exit_time && now >= exit_time) {
+                game_finish(poles, false);
+                return;
+            }
+        }
+        
+        // Input handling.
+        rp2040_input_message_t msg;
+        if (xQueueReceive(buttonQueue, &msg, 1) && msg.state) {
+            if (msg.input == RP2040_INPUT_BUTTON_ACCEPT && bard.alive) {
+                // Jump.
+                bard.vel    = JUMP_HEIGHT;
+                bard.paused = false;
+                audio_play(SFX_JUMP);
+            } else if (msg.input == RP2040_INPUT_BUTTON_BACK && bard.alive) {
+                // Pause.
+                bard.paused = !bard.paused;
+            } else if (msg.input == RP2040_INPUT_JOYSTICK_UP && DO_DEBUG(&bard)) {
+                // Debug: Move up.
+                bard.y -= 5;
+            } else if (msg.input == RP2040_INPUT_JOYSTICK_DOWN && DO_DEBUG(&bard)) {
+                // Debug: Move down.
+                bard.y += 5;
+            } else if (msg.input == RP2040_INPUT_JOYSTICK_LEFT && DO_DEBUG(&bard)) {
+                // Debug: Move left.
+                bard.level_pos -= 5;
+            } else if (msg.input == RP2040_INPUT_JOYSTICK_RIGHT && DO_DEBUG(&bard)) {
+                // Debug: Move right.
+                bard.level_pos += 5;
+            } else if (msg.input == RP2040_INPUT_JOYSTICK_PRESS) {
+                // Enable/disable debug.
+                debug_state = !debug_state;
+            } else if (msg.input == RP2040_INPUT_BUTTON_HOME) {
+                // Suspend, a run that is already over isn't worth keeping.
+                if (bard.alive) save_store(&bard, poles, rng_state);
+                game_finish(poles, true);
+                return;
+            }
+        }
+        
+        // Hand this step over to the renderer.
+        game_snapshot(game_back(), &bard, poles);
+        game_back()->ghost       = ghost;
+        game_back()->ghost_y     = ghost_y;
+        game_back()->ghost_angle = ghost_angle;
+        game_publish();
+        // Wait for the renderer to pick it up before simulating the next.
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    }
+}
+
+
+
+// Starts a new game on the simulation core, or resumes the suspended one.
+void game_start(bool resume) {
+    // Reset the triple buffer.
+    back_frame   = 0;
+    shared_frame = 1;
+    front_frame  = 2;
+    render_task  = xTaskGetCurrentTaskHandle();
+    ulTaskNotifyTake(pdTRUE, 0);
+    
+    xTaskCreatePinnedToCore(game_task, "game", GAME_STACK, (void *) resume, SIM_PRIORITY, &sim_task, SIM_CORE);
+}
+
+// Waits for and gets the newest frame published by the simulation.
+const frame_t *game_acquire() {
+    while (!(atomic_load(&shared_frame) & FRAME_FRESH)) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    }
+    front_frame = atomic_exchange(&shared_frame, front_frame) & FRAME_INDEX;
+    // Let the simulation start on the next step.
+    if (!frames[front_frame].finished) {
+        xTaskNotifyGive(sim_task);
+    }
+    return &frames[front_frame];
+}
@@ -0,0 +1,322 @@
+
+#include "ghost.h"
+#include "stdio.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+
+static const char *TAG = "ghost";
+
+typedef struct {
+    // Always GHOST_MAGIC.
+    uint32_t magic;
+    // Always GHOST_VERSION.
+    uint32_t version;
+} ghost_header_t;
+
+typedef struct {
+    // GHOST_CMD_START or GHOST_CMD_FINISH.
+    int      type;
+    // Value of ring_head when the recording finished.
+    uint32_t head;
+    // Whether the finished recording was the best run.
+    bool     best;
+    // Playback session that a START reads ahead for.
+    uint32_t session;
+} ghost_cmd_t;
+
+typedef struct {
+    // Playback session, play_ready matches it once the writer task has read ahead for it.
+    uint32_t session;
+    // Whether the best run is being played back.
+    bool     active;
+    // Number of steps whose samples haven't been decoded yet, when the writer task fell behind.
+    uint32_t due;
+    // The previous sample, which deltas are relative to.
+    int      y, angle;
+} ghost_stream_t;
+
+// The best run, being played back.
+static ghost_stream_t   playback;
+// Bytes of the best run read ahead, filled by the writer task and drained by the simulation.
+static uint8_t          play_ring[GHOST_PLAY_RING];
+// Number of bytes ever read ahead.
+static _Atomic uint32_t play_head;
+// Number of bytes ever played back.
+static _Atomic uint32_t play_tail;
+// Whether the writer task has read the best run up to its end.
+static _Atomic bool     play_eof;
+// Playback session that the read ahead bytes belong to.
+static _Atomic uint32_t play_ready;
+// Recorded bytes waiting to be written, filled by the simulation and drained by the writer task.
+static uint8_t          ring[GHOST_RING];
+// Number of bytes ever recorded.
+static _Atomic uint32_t ring_head;
+// Number of bytes ever written.
+static _Atomic uint32_t ring_tail;
+// Commands for the writer task.
+static QueueHandle_t    writer_queue;
+// Whether the current run is being recorded.
+static bool             recording;
+// Whether the writer fell behind and the recording is incomplete.
+static bool             lost;
+// The previous recorded sample, which deltas are relative to.
+static int              rec_y, rec_angle;
+
+// Writes recorded bytes up to head, in at most two contiguous writes. Returns false if a write failed.
+static bool ghost_write(FILE *fd, uint32_t head) {
+    uint32_t tail = atomic_load_explicit(&ring_tail, memory_order_relaxed);
+    bool     ok   = true;
+    while (tail != head) {
+        uint32_t index = tail % GHOST_RING;
+        uint32_t chunk = GHOST_RING - index < head - tail ? GHOST_RING - index : head - tail;
+        if (fd && ok && fwrite(ring + index, 1, chunk, fd) != chunk) ok = false;
+        tail += chunk;
+        atomic_store_explicit(&ring_tail, tail, memory_order_release);
+    }
+    return ok;
+}
+
+// Reads the best run ahead into the playback ring until it is full, closes the file at the end.
+static void ghost_read_ahead(FILE **fd) {
+    uint32_t head = atomic_load_explicit(&play_head, memory_order_relaxed);
+    while (*fd) {
+        uint32_t room  = GHOST_PLAY_RING - (head - atomic_load_explicit(&play_tail, memory_order_acquire));
+        uint32_t index = head % GHOST_PLAY_RING;
+        uint32_t chunk = GHOST_PLAY_RING - index < room ? GHOST_PLAY_RING - index : room;
+        if (!chunk) return;
+        size_t got = fread(play_ring + index, 1, chunk, *fd);
+        head += got;
+        atomic_store_explicit(&play_head, head, memory_order_release);
+        if (got < chunk) {
+            // After the last byte, so the simulation sees everything before the end.
+            fclose(*fd);
+            *fd = NULL;
+            atomic_store_explicit(&play_eof, true, memory_order_release);
+        }
+    }
+}
+
+// Opens the best run and reads ahead for a new playback session.
+static void ghost_open_playback(FILE **fd, uint32_t session) {
+    if (*fd) fclose(*fd);
+    // The simulation waits for this session, so nothing it reads can be reset under it.
+    atomic_store(&play_eof, false);
+    atomic_store(&play_head, atomic_load(&play_tail));
+    
+    *fd = fopen(GHOST_PATH, "rb");
+    if (*fd) {
+        ghost_header_t header;
+        if (fread(&header, sizeof(header), 1, *fd) != 1
+                || header.magic != GHOST_MAGIC || header.version != GHOST_VERSION) {
+            ESP_LOGW(TAG, "Ignoring an invalid trace.");
+            fclose(*fd);
+            *fd = NULL;
+        }
+    }
+    if (*fd) {
+        ghost_read_ahead(fd);
+    } else {
+        atomic_store(&play_eof, true);
+    }
+    atomic_store_explicit(&play_ready, session, memory_order_release);
+}
+
+// Writes recordings to FAT and reads the best run ahead, away from the game.
+static void ghost_task(void *args) {
+    FILE *fd      = NULL;
+    FILE *play_fd = NULL;
+    bool  active  = false;
+    bool  failed  = false;
+    while (1) {
+        ghost_cmd_t cmd;
+        bool got = xQueueReceive(writer_queue, &cmd, pdMS_TO_TICKS(GHOST_WRITE_MS));
+        
+        if (got && cmd.type == GHOST_CMD_START) {
+            // A recording that never finished isn't kept.
+            if (fd) {
+                fclose(fd);
+                remove(GHOST_TEMP);
+            }
+            fd     = fopen(GHOST_TEMP, "wb");
+            active = true;
+            failed = !fd;
+            ghost_header_t header = {
+                .magic   = GHOST_MAGIC,
+                .version = GHOST_VERSION,
+            };
+            if (fd && fwrite(&header, sizeof(header), 1, fd) != 1) failed = true;
+            if (failed) ESP_LOGW(TAG, "Can't record a trace.");
+            ghost_open_playback(&play_fd, cmd.session);
+            
+        } else if (got && cmd.type == GHOST_CMD_FINISH) {
+            if (play_fd) {
+                fclose(play_fd);
+                play_fd = NULL;
+            }
+            if (!ghost_write(fd, cmd.head)) failed = true;
+            active = false;
+            if (!fd) continue;
+            fclose(fd);
+            fd = NULL;
+            // FAT can't rename over an existing file.
+            if (cmd.best && !failed) {
+                remove(GHOST_PATH);
+                rename(GHOST_TEMP, GHOST_PATH);
+            } else {
+                if (cmd.best) ESP_LOGW(TAG, "Failed to write the trace, the best run isn't kept.");
+                remove(GHOST_TEMP);
+            }
+            
+        } else if (active) {
+            // Full batches only, so FAT sees few large writes.
+            uint32_t tail = atomic_load(&ring_tail);
+            while (atomic_load(&ring_head) - tail >= GHOST_BATCH) {
+                tail += GHOST_BATCH;
+                if (!ghost_write(fd, tail)) failed = true;
+            }
+        }
+        
+        // Keep the playback ring topped up.
+        ghost_read_ahead(&play_fd);
+    }
+}
+
+// Starts the writer task.
+bool ghost_init() {
+    writer_queue = xQueueCreate(GHOST_QUEUE, sizeof(ghost_cmd_t));
+    if (!writer_queue) return false;
+    // Writes are never urgent, but should keep up with the ring.
+    return xTaskCreatePinnedToCore(
+        ghost_task, "ghost", GHOST_STACK, NULL,
+        tskIDLE_PRIORITY + 1, NULL, GHOST_CORE
+    ) == pdPASS;
+}
+
+// Opens the best run for playback and starts recording a new one.
+void ghost_start() {
+    ghost_finish(false);
+    if (!storage_ready() || !writer_queue) return;
+    
+    // The writer task opens both files, and reads the best run ahead for this session.
+    uint32_t session = playback.session + 1;
+    ghost_cmd_t cmd = {
+        .type    = GHOST_CMD_START,
+        .session = session,
+    };
+    recording = xQueueSend(writer_queue, &cmd, 0) == pdTRUE;
+    playback  = (ghost_stream_t) {
+        .session = session,
+        .active  = recording,
+    };
+    rec_y     = 0;
+    rec_angle = 0;
+}
+
+// Records the bard's position for this step, never blocks.
+void ghost_record(const bard_t *bard) {
+    if (!recording) return;
+    uint32_t head = atomic_load_explicit(&ring_head, memory_order_relaxed);
+    if (head + GHOST_MAX_SAMPLE - atomic_load_explicit(&ring_tail, memory_order_acquire) > GHOST_RING) {
+        // The writer fell behind, a trace with a gap is useless.
+        recording = false;
+        lost      = true;
+        return;
+    }
+    
+    int y     = lroundf(bard->y * GHOST_Y_SCALE);
+    int angle = lroundf(bard->angle * GHOST_ANGLE_SCALE);
+    int dy    = y - rec_y;
+    int da    = angle - rec_angle;
+    uint8_t out[GHOST_MAX_SAMPLE];
+    size_t  len;
+    if (dy > GHOST_ESCAPE && dy <= INT8_MAX && da > GHOST_ESCAPE && da <= INT8_MAX) {
+        // Small changes fit a byte each, which is nearly every step.
+        out[0] = (int8_t) dy;
+        out[1] = (int8_t) da;
+        len    = 2;
+    } else {
+        // Otherwise store the absolute sample.
+        out[0] = (uint8_t) GHOST_ESCAPE;
+        out[1] = (uint16_t) y;
+        out[2] = (uint16_t) y >> 8;
+        out[3] = (uint16_t) angle;
+        out[4] = (uint16_t) angle >> 8;
+        len    = 5;
+    }
+    for (size_t i = 0; i < len; i++) {
+        ring[(head + i) % GHOST_RING] = out[i];
+    }
+    atomic_store_explicit(&ring_head, head + len, memory_order_release);
+    rec_y     = y;
+    rec_angle = angle;
+}
+
+// Decodes the next sample from the playback ring, returns its size or 0 if it isn't all there yet.
+static size_t ghost_decode(uint32_t tail, uint32_t head) {
+    uint8_t in[GHOST_MAX_SAMPLE];
+    size_t  len = head - tail < GHOST_MAX_SAMPLE ? head - tail : GHOST_MAX_SAMPLE;
+    for (size_t i = 0; i < len; i++) {
+        in[i] = play_ring[(tail + i) % GHOST_PLAY_RING];
+    }
+    
+    if (len >= 1 && (int8_t) in[0] == GHOST_ESCAPE) {
+        if (len < 5) return 0;
+        playback.y     = (int16_t) (in[1] | (in[2] << 8));
+        playback.angle = (int16_t) (in[3] | (in[4] << 8));
+        return 5;
+    } else if (len >= 2) {
+        playback.y     += (int8_t) in[0];
+        playback.angle += (int8_t) in[1];
+        return 2;
+    }
+    return 0;
+}
+
+// Gets the best run's position for this step, returns false when there is none.
+bool ghost_next(float *y, float *angle) {
+    if (!playback.active) return false;
+    playback.due ++;
+    // Nothing to play until the writer task has read ahead for this run.
+    if (atomic_load_explicit(&play_ready, memory_order_acquire) != playback.session) return false;
+    
+    // The end flag is read first, so the head read after it includes every byte.
+    bool     eof  = atomic_load_explicit(&play_eof, memory_order_acquire);
+    uint32_t head = atomic_load_explicit(&play_head, memory_order_acquire);
+    uint32_t tail = atomic_load_explicit(&play_tail, memory_order_relaxed);
+    
+    // Catch up on steps the writer task was behind for, so the ghost stays in step.
+    while (playback.due) {
+        size_t len = ghost_decode(tail, head);
+        if (!len) break;
+        tail += len;
+        playback.due --;
+    }
+    atomic_store_explicit(&play_tail, tail, memory_order_release);
+    
+    if (playback.due) {
+        // The best run ended here, or the writer task is behind.
+        if (eof) playback.active = false;
+        return false;
+    }
+    *y     = playback.y / (float) GHOST_Y_SCALE;
+    *angle = playback.angle / (float) GHOST_ANGLE_SCALE;
+    return true;
+}
+
+// Stops playback and recording, the writer task keeps the recording if it was the best run.
+void ghost_finish(bool best) {
+    // The writer task closes the best run, and ignores the ring until the next session.
+    playback.active = false;
+    
+    if (recording || lost) {
+        if (lost) ESP_LOGW(TAG, "The trace fell behind, it isn't kept.");
+        ghost_cmd_t cmd = {
+            .type = GHOST_CMD_FINISH,
+            .head = atomic_load(&ring_head),
+            .best = best && !lost,
+        };
+        xQueueSend(writer_queue, &cmd, 0);
+    }
+    recording = false;
+    lost      = false;
+}
@@ -0,0 +1,32 @@
+
+#include "golden.h"
+#include "esp_rom_crc.h"
+
+// Hashes the masked pixels of each band of a full screen of RGB565 pixels.
+void golden_hash(const uint16_t *pixels, uint32_t *hashes) {
+    static uint16_t row[SCREEN_WIDTH];
+    for (int band = 0; band < RENDER_CHECK_BANDS; band++) {
+        uint32_t crc = 0;
+        for (int y = band * BAND_HEIGHT; y < (band + 1) * BAND_HEIGHT; y++) {
+            for (int x = 0; x < SCREEN_WIDTH; x++) {
+                row[x] = pixels[y * SCREEN_WIDTH + x] & RENDER_CHECK_MASK;
+            }
+            crc = esp_rom_crc32_le(crc, (const uint8_t *) row, sizeof(row));
+        }
+        hashes[band] = crc;
+    }
+}
+
+// Compares band hashes to golden ones, optionally counting the bands that differ.
+golden_result_t golden_compare(const uint32_t *golden, const uint32_t *hashes, int *differ) {
+    // An empty table isn't a match, it was never recorded.
+    bool recorded = false;
+    int  count    = 0;
+    for (int band = 0; band < RENDER_CHECK_BANDS; band++) {
+        if (golden[band]) recorded = true;
+        if (golden[band] != hashes[band]) count ++;
+    }
+    if (differ) *differ = count;
+    if (!recorded) return GOLDEN_UNRECORDED;
+    return count > RENDER_CHECK_TOLERANCE ? GOLDEN_FAIL : GOLDEN_OK;
+}
@@ -4,24 +4,39 @@
 #include "types.h"
 #include "main.h"
 #include "resources.h"
+#include "mem.h"
+#include "game.h"
+#include "emitter.h"
 #include "pax_shaders.h"
 
 // Gets a random variant not equal to the given existing.
 int random_variant   (int not_this);
+// Gets the colour of a pole variant.
+pax_col_t variant_color(int variant);
 // Draws the pole in the right place.
-void draw_pole       (bard_t *bard, pole_t *pole);
+void draw_pole       (pax_buf_t *gfx, bard_t *bard, pole_t *pole);
 // Draws the bard.
-void draw_bard       (bard_t *bard);
+void draw_bard       (pax_buf_t *gfx, bard_t *bard);
+// Draws the best run's ghost, a see-through bard.
+void draw_ghost      (pax_buf_t *gfx, float y, float angle);
 // Draws the background.
-void draw_background ();
+void draw_background (pax_buf_t *gfx);
+// Draws the ground.
+void draw_ground     (pax_buf_t *gfx);
 
 // Apply physics to all particles.
 void render_particles(bard_t *bard);
 // Draws all particles.
-void draw_particles  (bard_t *bard);
+void draw_particles  (pax_buf_t *gfx, bard_t *bard, const particle_t *parts, size_t num);
+// Gets the range of screen rows covered by particles.
+void particle_bounds (const particle_t *parts, size_t num, int *top, int *bottom);
+// Copies up to max particles into an array, returns the number copied.
+size_t particle_snapshot(particle_t *out, size_t max);
 // Delete all particles.
 void particle_clear  ();
 // Spawns a number of particles, spread around the original position.
+// Rectangular spreads within spread_x by spread_y, radial within a circle of radius spread_x,
+// and cone within spread_x along the particle's velocity, spread_y radians to either side.
 void particle_spread (particle_t type, size_t number, float spread_x, float spread_y, spread_t spreading);
 // Adds one particle at the original position.
 void particle_add    (particle_t type);
@@ -0,0 +1,26 @@
+
+#pragma once
+
+#include "types.h"
+#include "stdatomic.h"
+
+// Sample rate of the embedded sounds and the output.
+#define AUDIO_RATE    16000
+// Number of blocks between CPU usage reports.
+#define AUDIO_REPORT  1024
+// Core that mixes audio, away from rendering.
+#define AUDIO_CORE    1
+// Stack size of the mixing task.
+#define AUDIO_STACK   3072
+
+typedef enum {
+    SFX_JUMP,
+    SFX_SCORE,
+    SFX_DEATH,
+    SFX_COUNT,
+} sfx_t;
+
+// Starts the audio output and the mixing task.
+bool audio_init();
+// Starts playing a sound effect, safe to call from any task.
+void audio_play(sfx_t sfx);
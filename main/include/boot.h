@@ -0,0 +1,16 @@
+
+#pragma once
+
+#include "types.h"
+
+// Maximum number of boot phases that are recorded.
+#define BOOT_MAX_PHASES 16
+// Core that runs the background part of the boot.
+#define BOOT_CORE       1
+// Stack size of the background boot task.
+#define BOOT_STACK      4096
+
+// Records that a boot phase has just finished.
+void boot_mark       (const char *phase);
+// Reports the boot phases the first time a frame reaches the screen, later phases are logged as they finish.
+void boot_first_frame();
@@ -0,0 +1,25 @@
+
+#pragma once
+
+#include "types.h"
+
+// Size of the bard's collision masks, one 64-bit word per row.
+#define COLL_SIZE   48
+// Distance from the center of a mask to its edges.
+#define COLL_RADIUS (COLL_SIZE / 2)
+// Number of precomputed rotations of the bard, which repeats every quarter turn.
+#define COLL_STEPS  32
+
+// The bard overlaps the top part of the pole.
+#define COLL_TOP    1
+// The bard overlaps the bottom part of the pole.
+#define COLL_BOTTOM 2
+
+// Builds the bard's collision masks, does nothing if already built.
+void collision_init  ();
+// Tests the bard against a pole, returns a combination of COLL_TOP and COLL_BOTTOM.
+int  collision_pole  (const bard_t *bard, const pole_t *pole);
+// Gets the screen rectangle around the bard's current mask.
+void collision_bounds(const bard_t *bard, int *x, int *y, int *width, int *height);
+// Gets how far the bard's current mask reaches right of its center, in whole pixels.
+int  collision_right (const bard_t *bard);
@@ -0,0 +1,40 @@
+
+#pragma once
+
+#include "types.h"
+
+// Height of a single band in pixels, must divide SCREEN_HEIGHT.
+#define BAND_HEIGHT 24
+// Maximum number of layers in a scene.
+#define MAX_LAYERS  48
+
+typedef struct layer layer_t;
+
+// Draws a layer into a band, the band is already offset to screen coordinates.
+typedef void (*layer_draw_t)(pax_buf_t *gfx, const layer_t *layer);
+
+struct layer {
+    /* ==== Bounds ==== */
+    // The first screen row covered by the layer.
+    int          top;
+    // The row after the last screen row covered by the layer.
+    int          bottom;
+    /* ==== Drawing ==== */
+    // The function that draws the layer.
+    layer_draw_t draw;
+    // Context passed to the draw function.
+    const void  *ctx;
+    // Arguments passed to the draw function.
+    const void  *args;
+};
+
+// Allocates the band buffer.
+bool comp_init      ();
+// Removes all layers from the scene.
+void comp_clear     ();
+// Adds a layer to the scene, covering the screen rows [top, bottom).
+void comp_add       (int top, int bottom, layer_draw_t draw, const void *ctx, const void *args);
+// Renders the scene band by band and sends each band to the screen.
+void comp_flush     ();
+// Renders the entire scene into a full-size buffer.
+void comp_render    (pax_buf_t *target);
@@ -0,0 +1,35 @@
+
+#pragma once
+
+#include "types.h"
+#include "stdatomic.h"
+#include "quality.h"
+
+// Maximum number of emitters at the same time.
+#define MAX_EMITTERS        4
+// Maximum number of live particles at full detail.
+#define PARTICLE_BUDGET     MAX_FRAME_PARTICLES
+// Number of particle detail levels, 0 is full detail.
+#define PARTICLE_LODS       4
+// First detail level that draws particles as plain squares.
+#define PARTICLE_LOD_SIMPLE 2
+
+// Adds a continuous emitter, spawning rate particles per frame of the given type.
+emitter_t *emitter_add    (particle_t type, float rate, float spread_x, float spread_y, spread_t spreading);
+// Moves an emitter to a new position in the level.
+void       emitter_move   (emitter_t *emitter, float x, float y);
+// Removes an emitter, its particles live on.
+void       emitter_remove (emitter_t *emitter);
+// Removes all emitters.
+void       emitter_clear  ();
+// Spawns particles from all emitters.
+void       render_emitters();
+
+// Gets the current particle detail level.
+int        particle_lod       ();
+// Gets the maximum number of live particles at the current detail level.
+size_t     particle_budget    ();
+// Scales a number of particles to spawn to the current detail level.
+size_t     particle_lod_scale (size_t number);
+// Gets how many frames particles age per update at the current detail level.
+int        particle_age_step  ();
@@ -0,0 +1,25 @@
+
+#pragma once
+
+#include "main.h"
+#include "stdatomic.h"
+#include "save.h"
+#include "ghost.h"
+
+// Core that runs the simulation, rendering stays on the core that calls ingame().
+#define SIM_CORE     1
+// Priority of the simulation task, above the LED, telemetry, ghost and leaderboard tasks that share its core.
+#define SIM_PRIORITY (tskIDLE_PRIORITY + 2)
+// Stack size of the simulation task, the ghost task does its file access.
+#define GAME_STACK   4096
+// Bits of the shared frame index that hold the index.
+#define FRAME_INDEX  3
+// Bit of the shared frame index that is set when the frame is newer than the reader's.
+#define FRAME_FRESH  4
+
+// Starts a new game on the simulation core, or resumes the suspended one.
+void game_start(bool resume);
+// Gets a random number from the game's own generator, which can be saved.
+uint32_t game_random();
+// Waits for and gets the newest frame published by the simulation.
+const frame_t *game_acquire();
@@ -0,0 +1,53 @@
+
+#pragma once
+
+#include "types.h"
+#include "storage.h"
+#include "stdatomic.h"
+
+// The best run's trace.
+#define GHOST_PATH        STORAGE_DIR "/ghost.bin"
+// The trace being recorded, until it turns out to be the best.
+#define GHOST_TEMP        STORAGE_DIR "/ghost.tmp"
+// Marks a trace, "FBGH" in little endian.
+#define GHOST_MAGIC       0x48474246
+// Increase whenever the encoding below changes.
+#define GHOST_VERSION     1
+// Number of bytes of the best run read ahead for playback, must be a power of two.
+#define GHOST_PLAY_RING   1024
+// Number of bytes of recording waiting to be written, must be a power of two.
+#define GHOST_RING        2048
+// Number of bytes written at a time.
+#define GHOST_BATCH       512
+// Time between checks for a full batch and for room to read ahead.
+#define GHOST_WRITE_MS    250
+// Number of commands for the writer task that can wait.
+#define GHOST_QUEUE       4
+// Core that runs the writer task.
+#define GHOST_CORE        1
+// Stack size of the writer task.
+#define GHOST_STACK       3072
+// Steps per pixel that the height is stored in.
+#define GHOST_Y_SCALE     4
+// Steps per radian that the angle is stored in.
+#define GHOST_ANGLE_SCALE 256
+// Delta that marks an absolute sample, when the delta doesn't fit a byte.
+#define GHOST_ESCAPE      -128
+// Largest size of a single encoded sample.
+#define GHOST_MAX_SAMPLE  5
+
+// Asks the writer task to open a new recording and read the best run ahead.
+#define GHOST_CMD_START   1
+// Asks the writer task to close the recording, keeping it if it was the best run, and stop reading ahead.
+#define GHOST_CMD_FINISH  2
+
+// Starts the writer task.
+bool ghost_init  ();
+// Opens the best run for playback and starts recording a new one.
+void ghost_start ();
+// Records the bard's position for this step, never blocks.
+void ghost_record(const bard_t *bard);
+// Gets the best run's position for this step, returns false when there is none.
+bool ghost_next  (float *y, float *angle);
+// Stops playback and recording, the writer task keeps the recording if it was the best run.
+void ghost_finish(bool best);
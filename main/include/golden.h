@@ -0,0 +1,26 @@
+
+#pragma once
+
+#include "types.h"
+#include "compositor.h"
+
+// Bits of each RGB565 pixel that are hashed, the two low bits of each channel are ignored.
+#define RENDER_CHECK_MASK      0xe79c
+// Number of bands per scene whose hash may differ from the golden hash.
+#define RENDER_CHECK_TOLERANCE 0
+// Number of hashed bands per scene.
+#define RENDER_CHECK_BANDS     (SCREEN_HEIGHT / BAND_HEIGHT)
+
+typedef enum {
+    // No golden hashes have been recorded for the scene.
+    GOLDEN_UNRECORDED,
+    // The scene matches its golden hashes.
+    GOLDEN_OK,
+    // More bands differ than the tolerance allows.
+    GOLDEN_FAIL,
+} golden_result_t;
+
+// Hashes the masked pixels of each band of a full screen of RGB565 pixels.
+void            golden_hash   (const uint16_t *pixels, uint32_t *hashes);
+// Compares band hashes to golden ones, optionally counting the bands that differ.
+golden_result_t golden_compare(const uint32_t *golden, const uint32_t *hashes, int *differ);
@@ -0,0 +1,91 @@
+
+#pragma once
+
+#include "types.h"
+#include "stdatomic.h"
+
+// NVS key of the runs waiting to be uploaded.
+#define LB_QUEUE_KEY    "fbird_lb_queue"
+// NVS key of the cached top scores.
+#define LB_TOP_KEY      "fbird_lb_top"
+// Maximum number of runs waiting to be uploaded, the lowest scores make way.
+#define LB_QUEUE_MAX    16
+// Number of submitted runs that can wait for the sync task to take them.
+#define LB_SUBMIT_MAX   4
+// Number of top scores fetched and cached.
+#define LB_TOP          5
+// Maximum length of a player name, including the NUL.
+#define LB_NAME_LEN     16
+// Maximum length of an ETag, including the NUL.
+#define LB_ETAG_LEN     48
+// Maximum size of the top scores response.
+#define LB_BODY_MAX     1024
+// Time between syncs when nothing is waiting.
+#ifndef LB_INTERVAL_MS
+#define LB_INTERVAL_MS  (10 * 60 * 1000)
+#endif
+// Delay before retrying a failed sync, doubled after each failure.
+#ifndef LB_RETRY_MIN_MS
+#define LB_RETRY_MIN_MS (5 * 1000)
+#endif
+// Longest delay before retrying a failed sync.
+#ifndef LB_RETRY_MAX_MS
+#define LB_RETRY_MAX_MS (10 * 60 * 1000)
+#endif
+// Timeout of a single request.
+#ifndef LB_TIMEOUT_MS
+#define LB_TIMEOUT_MS   5000
+#endif
+// Time the player has to idle in the menu before the radio is turned on.
+#ifndef LB_IDLE_MS
+#define LB_IDLE_MS      3000
+#endif
+// Time between checks for a due sync.
+#ifndef LB_POLL_MS
+#define LB_POLL_MS      500
+#endif
+// Number of top scores shown in the main menu.
+#define LB_MENU_ROWS    3
+// Core that runs the sync task.
+#define LB_CORE         1
+// Stack size of the sync task, TLS needs a lot.
+#define LB_STACK        8192
+
+typedef struct lb_run lb_run_t;
+typedef struct lb_entry lb_entry_t;
+typedef struct lb_top lb_top_t;
+
+// A finished run, waiting to be uploaded.
+struct lb_run {
+    // Score of the run.
+    uint64_t score;
+    // Random number, so the server can ignore a batch that is sent twice.
+    uint32_t id;
+};
+
+// A single entry of the leaderboard.
+struct lb_entry {
+    // Name of the player.
+    char     name[LB_NAME_LEN];
+    // Their best score.
+    uint64_t score;
+};
+
+// The top scores as last fetched.
+struct lb_top {
+    // ETag of the response, for conditional requests.
+    char       etag[LB_ETAG_LEN];
+    // Number of valid entries.
+    uint8_t    count;
+    // Entries, best first.
+    lb_entry_t entries[LB_TOP];
+};
+
+// Loads the queue and cached top scores and starts syncing, once NVS is up.
+bool leaderboard_init  ();
+// Queues a finished run for upload, never blocks.
+void leaderboard_submit(uint64_t score);
+// Tells whether the player idles in the menu, syncs only happen then.
+void leaderboard_idle  (bool idle);
+// Copies the cached top scores if they changed, never blocks. Returns true if out was updated.
+bool leaderboard_top   (lb_top_t *out);
@@ -0,0 +1,40 @@
+
+#pragma once
+
+#include "types.h"
+#include "stdatomic.h"
+
+// Number of LEDs on the badge.
+#define LED_COUNT      5
+// Brightest an LED is driven, out of 255, to keep the current down.
+#define LED_BRIGHTNESS 48
+// Time between LED frames while an effect runs.
+#define LED_FRAME_MS   20
+// Number of events the queue holds, must be a power of two.
+#define LED_QUEUE      16
+// Duration of the score flash.
+#define LED_FLASH_MS   200
+// Duration of the death animation.
+#define LED_DEATH_MS   1200
+// Period of the pulse in the pole colour.
+#define LED_PULSE_MS   2000
+// Core that runs the LED task.
+#define LED_CORE       1
+// Stack size of the LED task.
+#define LED_STACK      2048
+
+typedef enum {
+    // The score went up.
+    LED_SCORE,
+    // The bard died.
+    LED_DEATH,
+    // The poles changed colour, pulse in the new one.
+    LED_VARIANT,
+    // The game ended, turn the LEDs off.
+    LED_OFF,
+} led_event_type_t;
+
+// Starts the LEDs and the effects task.
+bool led_init();
+// Queues an event for the effects task, never blocks. Only the simulation may call this.
+void led_event(led_event_type_t type, pax_col_t color);
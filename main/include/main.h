@@ -19,11 +19,25 @@
 
 #include "types.h"
 #include "artwork.h"
+#include "compositor.h"
+#include "game.h"
+#include "audio.h"
+#include "boot.h"
+#include "collision.h"
+#include "quality.h"
+#include "rendercheck.h"
+#include "storage.h"
+#include "ghost.h"
+#include "led.h"
+#include "telemetry.h"
+#include "leaderboard.h"
 
-// Flush the buffer to screen.
+// Flush the scene to screen.
 void disp_flush();
 // Exit to the launcher.
 void exit_to_launcher();
+// Init (but not connect to) WiFi, the first time it is needed.
+void wifi_lazy_init();
 
 // Gets or reads from NVS, the high score.
 uint64_t get_hiscore();
@@ -32,11 +46,16 @@ void set_hiscore(uint64_t newscore);
 // Get text in the format "High score: %d".
 const char *text_hiscore();
 // Draws a title and optional subtitle in the middle of the screen.
-void draw_title(pax_col_t col, const char *title, const char *subtitle);
+void draw_title(pax_buf_t *gfx, pax_col_t col, const char *title, const char *subtitle);
+
+// Builds the main menu scene around a dummy bard.
+void scene_menu(const bard_t *dummy, const char *subtitle);
+// Builds the in-game scene for a frame.
+void scene_game(const frame_t *frame);
 
 // Renders pole physics.
 void render_pole(bard_t *bard, pole_t *pole);
 // Main menu loop.
 void mainmenu();
-// Level loop.
-void ingame();
+// Level loop, optionally resuming the suspended game.
+void ingame(bool resume);
@@ -0,0 +1,29 @@
+
+#pragma once
+
+#include "types.h"
+#include "sys/types.h"
+
+// Number of frames between memory reports while in game.
+#define MEM_REPORT_FRAMES 600
+
+typedef enum {
+    MEM_POLES,
+    MEM_PARTICLES,
+    MEM_RESOURCES,
+    MEM_FRAMEBUFFER,
+    MEM_TAG_COUNT,
+} mem_tag_t;
+
+// Allocates memory on behalf of a subsystem, returns NULL when out of memory.
+void *mem_alloc     (mem_tag_t tag, size_t size);
+// Allocates memory with specific capabilities on behalf of a subsystem.
+void *mem_alloc_caps(mem_tag_t tag, size_t size, uint32_t caps);
+// Frees memory from mem_alloc or mem_alloc_caps.
+void  mem_free      (void *ptr);
+// Accounts for memory that a subsystem allocated through another library.
+void  mem_track     (mem_tag_t tag, ssize_t delta);
+// Marks the end of a frame for the allocation rate statistics.
+void  mem_mark_frame();
+// Logs live, peak and allocation rate for all subsystems.
+void  mem_report    ();
@@ -0,0 +1,18 @@
+
+#pragma once
+
+#include "stdint.h"
+#include "stddef.h"
+#include "stdbool.h"
+
+// Number of sounds that can play at the same time.
+#define MIXER_VOICES 4
+// Number of samples mixed at a time.
+#define MIXER_BLOCK  256
+
+// Starts a 16-bit signed mono sample on a free voice, stealing one if needed.
+void mixer_start(const int16_t *start, const int16_t *end);
+// Mixes all active voices into one block of interleaved stereo.
+void mixer_mix  (int16_t out[MIXER_BLOCK * 2]);
+// Whether any voice is still playing.
+bool mixer_busy ();
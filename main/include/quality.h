@@ -0,0 +1,23 @@
+
+#pragma once
+
+#include "types.h"
+#include "stdatomic.h"
+
+// Frame time that the game aims for.
+#define FRAME_TARGET_US     33333
+// Number of frames in the rolling frame time.
+#define QUALITY_WINDOW      16
+// Number of slow frames in a row before lowering quality.
+#define QUALITY_DOWN_FRAMES 15
+// Number of fast frames in a row before raising quality.
+#define QUALITY_UP_FRAMES   120
+
+// Reports how long the last frame took, adjusting quality.
+void             quality_frame(int64_t frame_us);
+// Returns to full quality and forgets past frame times.
+void             quality_reset();
+// Gets the index of the current quality tier, 0 being full quality.
+int              quality_tier ();
+// Gets the current quality tier.
+const quality_t *quality      ();
@@ -0,0 +1,16 @@
+
+#pragma once
+
+#include "types.h"
+#include "compositor.h"
+#include "golden.h"
+#include "storage.h"
+
+// Number of times each scene is rendered for timing.
+#define RENDER_CHECK_RUNS      8
+// Hashes of the last check, for tools/golden.py to record.
+#define RENDER_CHECK_PATH      STORAGE_DIR "/golden.txt"
+
+// Renders the canonical scenes, compares them to the golden hashes and shows the result.
+// Returns the number of scenes that don't match, or -1 if none could be compared.
+int render_check();
@@ -2,9 +2,30 @@
 #pragma once
 
 #include "types.h"
+#include "mem.h"
 #include "pax_codecs.h"
 #include "string.h"
+#include "storage.h"
 
+// Resource pack with a theme, loaded at boot when present.
+#define PACK_PATH        STORAGE_DIR "/theme.pak"
+// Marks a resource pack, "FBPK" in little endian.
+#define PACK_MAGIC       0x4b504246
+// Increase whenever the pack layout changes, tools/mkpack.py must match.
+#define PACK_VERSION     1
+// Maximum length of a resource name in a pack, including the NUL.
+#define PACK_NAME_LEN    24
+// Size of the read buffer of a pack.
+#define PACK_BUFFER      4096
+// A packed resource stored as a PNG.
+#define PACK_FORMAT_PNG  0
+// A packed resource stored as raw ARGB8888 pixels.
+#define PACK_FORMAT_ARGB 1
+
+// Reads a resource pack and loads all of its resources, so drawing never waits on the filesystem.
+bool resource_load_pack(const char *path);
+// Gets the name of a resource as stored in the resource table, NULL if it doesn't exist.
+const char *resource_name(const char *filename);
 // Get a resource that needs to be available for a long time.
 pax_buf_t *resource_get_long(const char *filename);
 // Get a resource that needs to be available until resource_mark_frame is called.
@@ -0,0 +1,18 @@
+
+#pragma once
+
+#include "types.h"
+
+// NVS key of the suspended game.
+#define SAVE_KEY     "fbird_save"
+// Marks a suspended game, "FBSV" in little endian.
+#define SAVE_MAGIC   0x56534246
+// Increase whenever bard_t or the records below change layout.
+#define SAVE_VERSION 1
+
+// Whether there is a suspended game to resume.
+bool    save_exists();
+// Writes the game state to flash in one go.
+bool    save_store (const bard_t *bard, const pole_t *poles, uint32_t rng);
+// Reads and removes the suspended game, returns its poles or NULL if there is none.
+pole_t *save_load  (bard_t *bard, uint32_t *rng);
@@ -0,0 +1,20 @@
+
+#pragma once
+
+#include "types.h"
+
+// Label of the FAT partition in partitions.csv.
+#define STORAGE_LABEL     "locfd"
+#ifndef STORAGE_PATH
+// Where the FAT partition is mounted, host tests point it elsewhere.
+#define STORAGE_PATH      "/locfd"
+#endif
+// Directory of the game's own files.
+#define STORAGE_DIR       STORAGE_PATH "/fbird"
+// Maximum number of files open at the same time.
+#define STORAGE_MAX_FILES 4
+
+// Mounts the FAT partition, never formats it.
+bool storage_mount();
+// Whether the FAT partition is mounted.
+bool storage_ready();
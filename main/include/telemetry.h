@@ -0,0 +1,89 @@
+
+#pragma once
+
+#include "types.h"
+#include "storage.h"
+#include "stdatomic.h"
+
+// Where telemetry is written, each game appends a session.
+#define TELEMETRY_PATH     STORAGE_DIR "/telemetry.bin"
+// Size at which the file is started over instead of appended to.
+#define TELEMETRY_MAX_SIZE (1024 * 1024)
+// Marks a session, "FBTM" in little endian.
+#define TELEMETRY_MAGIC    0x4d544246
+// Increase whenever the records change, tools/telemetry.py must match.
+#define TELEMETRY_VERSION  2
+// Number of records the ring holds, must be a power of two.
+#define TELEMETRY_RING     512
+// Number of records written at a time.
+#define TELEMETRY_BATCH    128
+// Longest wait for the last records to be written before leaving the app.
+#define TELEMETRY_EXIT_MS  500
+// Core that runs the writer task.
+#define TELEMETRY_CORE     1
+// Stack size of the writer task.
+#define TELEMETRY_STACK    3072
+
+// Number of session starts and ends that can wait for the writer task.
+#define TELEMETRY_REQ_QUEUE 4
+// Asks the writer task to start a session.
+#define TELEMETRY_REQ_START 1
+// Asks the writer task to end a session.
+#define TELEMETRY_REQ_END   2
+
+// Set in telemetry_record_t flags if the bard is alive.
+#define TELEMETRY_ALIVE    1
+// Set in telemetry_record_t flags if the game is paused.
+#define TELEMETRY_PAUSED   2
+
+typedef struct telemetry_header telemetry_header_t;
+typedef struct telemetry_record telemetry_record_t;
+
+// Start of a session, followed by records up to the next header.
+struct telemetry_header {
+    // Always TELEMETRY_MAGIC.
+    uint32_t magic;
+    // Always TELEMETRY_VERSION.
+    uint16_t version;
+    // Size of a record.
+    uint16_t record_size;
+    // Frame time the game aims for.
+    uint32_t target_us;
+    // Number of records dropped in this session, the ring was full. Written when the session ends.
+    uint32_t dropped;
+} __attribute__((packed));
+
+// A single frame.
+struct telemetry_record {
+    /* ==== Timing ==== */
+    // Number of the frame in the session.
+    uint32_t frame;
+    // Time since the previous frame.
+    uint32_t frame_us;
+    /* ==== Bard ==== */
+    // The bard's height and vertical velocity.
+    float    y, vel;
+    // Score so far.
+    uint32_t score;
+    /* ==== Difficulty ==== */
+    // Distance between and gap of new poles.
+    float    pole_dist, pole_gap;
+    /* ==== Load ==== */
+    // Number of poles and particles in the frame.
+    uint8_t  num_poles, num_particles;
+    // Quality tier the frame was drawn at.
+    uint8_t  quality;
+    // TELEMETRY_ALIVE and TELEMETRY_PAUSED.
+    uint8_t  flags;
+} __attribute__((packed));
+
+// Starts the writer task.
+bool telemetry_init ();
+// Starts a new session.
+void telemetry_start();
+// Records a frame, never blocks or allocates. Only the renderer may call this.
+void telemetry_frame(const frame_t *frame, int64_t frame_us);
+// Ends the session, writing out what's left.
+void telemetry_end  ();
+// Waits for the writer task to close the ended session, returns false on timeout.
+bool telemetry_wait (uint32_t timeout_ms);
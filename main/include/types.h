@@ -8,16 +8,25 @@
 #include "freertos/queue.h"
 #include "esp_log.h"
 #include "esp_system.h"
+#include "tuning.h"
 
+// Spreading modes, odd values also push particles away from the center.
 typedef enum {
     SPREAD_RECTANGULAR,
     REPEL_RECTANGULAR,
+    SPREAD_RADIAL,
+    REPEL_RADIAL,
+    SPREAD_CONE,
+    REPEL_CONE,
 } spread_t;
 
 typedef struct bard bard_t;
 typedef struct pole pole_t;
 typedef struct variant variant_t;
 typedef struct particle particle_t;
+typedef struct frame frame_t;
+typedef struct emitter emitter_t;
+typedef struct quality quality_t;
 
 struct bard {
     /* ==== Position ==== */
@@ -45,6 +54,8 @@ struct bard {
     uint64_t score;
     // Next score to increase difficulty after.
     uint64_t next_diff;
+    // Number of times the difficulty has increased.
+    int      diff_level;
     // Current variant to draw the poles as.
     int      pole_variant;
     // The number of poles produced so far.
@@ -106,6 +117,66 @@ struct particle {
     int         age;
 };
 
+struct emitter {
+    /* ==== Spawning ==== */
+    // The particle to spawn, including the emitter's position.
+    particle_t type;
+    // The number of particles to spawn per frame.
+    float      rate;
+    // Fraction of a particle left over from previous frames.
+    float      pending;
+    /* ==== Spreading ==== */
+    // Spreading distances, see particle_spread.
+    float      spread_x, spread_y;
+    // The way particles are spread.
+    spread_t   spreading;
+    /* ==== Miscellaneous ==== */
+    // Whether the emitter is in use.
+    bool       active;
+};
+
+struct quality {
+    // Name of the tier, for logging.
+    const char *name;
+    // Number of frames between updates of cached text.
+    int         text_interval;
+    // Whether the bard is drawn rotated.
+    bool        rotate_bard;
+    // Whether particles are spawned and drawn.
+    bool        particles;
+    // Particle detail level, 0 is full detail.
+    int         particle_lod;
+};
+
+// Maximum number of poles in a frame.
+#define MAX_FRAME_POLES     8
+// Maximum number of particles in a frame.
+#define MAX_FRAME_PARTICLES 64
+
+struct frame {
+    /* ==== Game state ==== */
+    // Copy of the bard.
+    bard_t     bard;
+    // Copies of the live poles, from left to right.
+    pole_t     poles[MAX_FRAME_POLES];
+    // Number of poles in the frame.
+    size_t     num_poles;
+    // Copies of the live particles.
+    particle_t particles[MAX_FRAME_PARTICLES];
+    // Number of particles in the frame.
+    size_t     num_particles;
+    /* ==== Ghost ==== */
+    // Whether the best run's ghost is shown.
+    bool       ghost;
+    // The ghost's height and angle.
+    float      ghost_y, ghost_angle;
+    /* ==== Miscellaneous ==== */
+    // Whether the game has ended, no further frames follow.
+    bool       finished;
+    // Whether the game ended because it was suspended.
+    bool       suspended;
+};
+
 // Default dust particle with a given X/Y.
 #define PARTICLE_DUST(particle_x, particle_y) (particle_t) {\
         .prev     = NULL,\
@@ -116,26 +187,43 @@ struct particle {
         .vy       = 0,\
         .gx       = 0,\
         .gy       = 0,\
-        .drag     = 0.2,\
+        .drag     = 0.2f,\
         .filename = "dust.png",\
         .color    = 0xffffffff,\
         .lifespan = 20,\
         .age      = 0,\
     }
 
-#define JUMP_HEIGHT  -8
-#define GRAVITY       2.0
-#define HITBOX_RADIUS 15
-#define POLE_LENIENCE 3
-#define POLE_WIDTH    50
+// Faint dust that trails behind the bard, with a given X/Y.
+#define PARTICLE_TRAIL(particle_x, particle_y) (particle_t) {\
+        .prev     = NULL,\
+        .next     = NULL,\
+        .x        = particle_x,\
+        .y        = particle_y,\
+        .vx       = 0,\
+        .vy       = 0,\
+        .gx       = 0,\
+        .gy       = 0.1f,\
+        .drag     = 0.1f,\
+        .filename = "dust.png",\
+        .color    = 0xffffffff,\
+        .lifespan = 12,\
+        .age      = 0,\
+    }
+
 #define EXIT_TIME     2000
+#define TRAIL_RATE    0.5f
+#define M_PI_F        ((float) M_PI)
+
+#define SCREEN_WIDTH    320
+#define SCREEN_HEIGHT   240
+#define GROUND_HEIGHT   30
+#define BARD_X          50
+#define BARD_MARGIN     22
+#define PARTICLE_MARGIN 16
 
-#define INITIAL_POLE_GAP  90
-#define MIN_POLE_GAP      50
-#define INITIAL_POLE_DIST 250
-#define MIN_POLE_DIST     100
-#define DIFF_INC_EVERY    5
-#define DIFF_FACTOR       0.1
+#define SCORE_CACHE_WIDTH  160
+#define SCORE_CACHE_HEIGHT 40
 
 #define SHOW_HITBOXES(bard) (debug_state)
 #define DO_DEBUG(bard) ((bard)->paused && debug_state)
@@ -143,7 +231,6 @@ struct particle {
 extern const pax_font_t *font_big;
 extern const pax_font_t *font_small;
 extern nvs_handle_t game_nvs;
-extern pax_buf_t buf;
 extern xQueueHandle buttonQueue;
 extern bool debug_state;
 
@@ -0,0 +1,305 @@
+
+#include "leaderboard.h"
+#include "main.h"
+#include "freertos/semphr.h"
+#include "freertos/queue.h"
+#include "esp_http_client.h"
+#include "esp_crt_bundle.h"
+#include "cJSON.h"
+#include "strings.h"
+
+static const char *TAG = "leaderboard";
+
+typedef enum {
+    // The step is done.
+    LB_OK,
+    // The step failed, but may work later.
+    LB_RETRY,
+    // The step can't work until the server changes, retrying is pointless.
+    LB_GIVE_UP,
+} lb_result_t;
+
+// Guards the top scores, never held over the network.
+static SemaphoreHandle_t lock;
+// Runs submitted by the game, for the sync task to take.
+static QueueHandle_t     submitted;
+// Runs waiting to be uploaded, only the sync task touches them.
+static lb_run_t  queue[LB_QUEUE_MAX];
+// Number of runs waiting to be uploaded.
+static size_t    queue_len;
+// The top scores as last fetched.
+static lb_top_t  top;
+// Increased every time the top scores change.
+static uint32_t  top_version;
+// The player's name, from the launcher's settings.
+static char      name[LB_NAME_LEN] = "Floppy bard";
+// The sync task.
+static TaskHandle_t sync_task;
+// Since when the player idles in the menu, 0 if they don't.
+static _Atomic int64_t idle_since;
+
+// ETag of the response being received.
+static char etag[LB_ETAG_LEN];
+// Body of the response being received.
+static char body[LB_BODY_MAX + 1];
+
+// Writes the queue to NVS.
+static void lb_store_queue() {
+    nvs_set_blob(game_nvs, LB_QUEUE_KEY, queue, queue_len * sizeof(lb_run_t));
+    nvs_commit(game_nvs);
+}
+
+// Adds a run to the queue, when full the lowest score makes way.
+static void lb_queue_run(const lb_run_t *run) {
+    if (queue_len < LB_QUEUE_MAX) {
+        queue[queue_len ++] = *run;
+        return;
+    }
+    size_t lowest = 0;
+    for (size_t i = 1; i < queue_len; i++) {
+        if (queue[i].score < queue[lowest].score) lowest = i;
+    }
+    if (queue[lowest].score < run->score) queue[lowest] = *run;
+}
+
+// Whether the player has idled in the menu long enough for the radio to be on.
+static bool lb_idle() {
+    int64_t since = atomic_load(&idle_since);
+    return since && esp_timer_get_time() - since >= LB_IDLE_MS * 1000LL;
+}
+
+// Keeps the ETag of responses.
+static esp_err_t lb_http_event(esp_http_client_event_t *event) {
+    if (event->event_id == HTTP_EVENT_ON_HEADER && !strcasecmp(event->header_key, "ETag")) {
+        strncpy(etag, event->header_value, LB_ETAG_LEN - 1);
+        etag[LB_ETAG_LEN - 1] = 0;
+    }
+    return ESP_OK;
+}
+
+// Makes a client for a path on the leaderboard server.
+static esp_http_client_handle_t lb_client(const char *path, esp_http_client_method_t method) {
+    char url[128];
+    snprintf(url, sizeof(url), "%s%s", CONFIG_FBIRD_LEADERBOARD_URL, path);
+    esp_http_client_config_t config = {
+        .url               = url,
+        .method            = method,
+        .timeout_ms        = LB_TIMEOUT_MS,
+        .event_handler     = lb_http_event,
+        .crt_bundle_attach = esp_crt_bundle_attach,
+    };
+    return esp_http_client_init(&config);
+}
+
+// Uploads all queued runs in one request.
+static lb_result_t lb_upload() {
+    if (!queue_len) return LB_OK;
+    
+    // {"name": "...", "runs": [{"score": 1, "id": 2}, ...]}
+    cJSON *root = cJSON_CreateObject();
+    cJSON_AddStringToObject(root, "name", name);
+    cJSON *runs = cJSON_AddArrayToObject(root, "runs");
+    for (size_t i = 0; i < queue_len; i++) {
+        cJSON *run = cJSON_CreateObject();
+        cJSON_AddNumberToObject(run, "score", queue[i].score);
+        cJSON_AddNumberToObject(run, "id", queue[i].id);
+        cJSON_AddItemToArray(runs, run);
+    }
+    char *json = cJSON_PrintUnformatted(root);
+    cJSON_Delete(root);
+    if (!json) return LB_RETRY;
+    
+    esp_http_client_handle_t client = lb_client("/runs", HTTP_METHOD_POST);
+    esp_http_client_set_header(client, "Content-Type", "application/json");
+    esp_http_client_set_post_field(client, json, strlen(json));
+    esp_err_t res    = esp_http_client_perform(client);
+    int       status = esp_http_client_get_status_code(client);
+    esp_http_client_cleanup(client);
+    free(json);
+    if (res || status / 100 != 2) {
+        ESP_LOGW(TAG, "Upload failed: %s, status %d", esp_err_to_name(res), status);
+        return LB_RETRY;
+    }
+    
+    // Runs submitted in the meantime are still in the submit queue.
+    ESP_LOGI(TAG, "Uploaded %u runs.", (unsigned) queue_len);
+    queue_len = 0;
+    lb_store_queue();
+    return LB_OK;
+}
+
+// Fetches the top scores unless they haven't changed.
+static lb_result_t lb_fetch() {
+    char path[32];
+    snprintf(path, sizeof(path), "/top?n=%d", LB_TOP);
+    esp_http_client_handle_t client = lb_client(path, HTTP_METHOD_GET);
+    // Only get a body if the scores changed since the last fetch.
+    if (top.etag[0]) esp_http_client_set_header(client, "If-None-Match", top.etag);
+    etag[0] = 0;
+    
+    esp_err_t res = esp_http_client_open(client, 0);
+    int  len      = 0;
+    bool too_long = false;
+    if (!res && esp_http_client_fetch_headers(client) >= 0) {
+        int read;
+        while (len < LB_BODY_MAX && (read = esp_http_client_read(client, body + len, LB_BODY_MAX - len)) > 0) {
+            len += read;
+        }
+        // A full buffer is only a problem if there is more.
+        char more;
+        too_long = len == LB_BODY_MAX && esp_http_client_read(client, &more, 1) > 0;
+    }
+    int status = esp_http_client_get_status_code(client);
+    esp_http_client_cleanup(client);
+    body[len] = 0;
+    
+    if (status == 304) return LB_OK;
+    if (res || status != 200) {
+        ESP_LOGW(TAG, "Fetch failed: %s, status %d", esp_err_to_name(res), status);
+        return LB_RETRY;
+    }
+    if (too_long) {
+        // The same response comes back every time, so don't hammer the server with it.
+        ESP_LOGE(TAG, "Top scores are over %d bytes, giving up until the next sync.", LB_BODY_MAX);
+        return LB_GIVE_UP;
+    }
+    
+    // [{"name": "...", "score": 1}, ...]
+    lb_top_t fresh = { .count = 0 };
+    strcpy(fresh.etag, etag);
+    cJSON *root = cJSON_Parse(body);
+    cJSON *entry;
+    cJSON_ArrayForEach(entry, root) {
+        if (fresh.count >= LB_TOP) break;
+        cJSON *entry_name  = cJSON_GetObjectItem(entry, "name");
+        cJSON *entry_score = cJSON_GetObjectItem(entry, "score");
+        if (!cJSON_IsString(entry_name) || !cJSON_IsNumber(entry_score)) continue;
+        lb_entry_t *out = &fresh.entries[fresh.count ++];
+        strncpy(out->name, entry_name->valuestring, LB_NAME_LEN - 1);
+        out->name[LB_NAME_LEN - 1] = 0;
+        out->score = entry_score->valuedouble;
+    }
+    cJSON_Delete(root);
+    if (!root) {
+        ESP_LOGE(TAG, "Invalid top scores, giving up until the next sync.");
+        return LB_GIVE_UP;
+    }
+    
+    xSemaphoreTake(lock, portMAX_DELAY);
+    top = fresh;
+    top_version ++;
+    xSemaphoreGive(lock);
+    nvs_set_blob(game_nvs, LB_TOP_KEY, &fresh, sizeof(fresh));
+    nvs_commit(game_nvs);
+    return LB_OK;
+}
+
+// Connects, uploads, fetches and disconnects again. Stops early when the player leaves the menu.
+static lb_result_t lb_sync() {
+    wifi_lazy_init();
+    if (!wifi_connect_to_stored()) {
+        ESP_LOGW(TAG, "No WiFi, trying again later.");
+        return LB_RETRY;
+    }
+    lb_result_t res = lb_idle() ? lb_upload() : LB_RETRY;
+    if (res == LB_OK) res = lb_idle() ? lb_fetch() : LB_RETRY;
+    // Keep the radio off while playing.
+    wifi_disconnect_and_disable();
+    return res;
+}
+
+// Takes submitted runs and syncs in the background, only while the player idles in the menu.
+static void lb_task(void *args) {
+    int64_t next_sync = 0;
+    int     retry_ms  = LB_RETRY_MIN_MS;
+    while (1) {
+        // Runs are persisted here, so the game never waits for NVS.
+        lb_run_t run;
+        if (xQueueReceive(submitted, &run, pdMS_TO_TICKS(LB_POLL_MS))) {
+            lb_queue_run(&run);
+            while (xQueueReceive(submitted, &run, 0)) lb_queue_run(&run);
+            lb_store_queue();
+            // A new run is worth syncing for, unless a failure is being backed off.
+            if (retry_ms == LB_RETRY_MIN_MS) next_sync = 0;
+        }
+        
+        int64_t now = esp_timer_get_time();
+        if (now < next_sync || !lb_idle()) continue;
+        lb_result_t res = lb_sync();
+        if (res == LB_RETRY && !lb_idle()) {
+            // Cut short by a game, not a failure, so try again once back in the menu.
+            continue;
+        } else if (res == LB_RETRY) {
+            // Back off, new runs wait in the queue until the next try.
+            next_sync = esp_timer_get_time() + retry_ms * 1000LL;
+            retry_ms  = retry_ms * 2 > LB_RETRY_MAX_MS ? LB_RETRY_MAX_MS : retry_ms * 2;
+        } else {
+            // Giving up still waits for the interval, the server may be fixed by then.
+            next_sync = esp_timer_get_time() + LB_INTERVAL_MS * 1000LL;
+            retry_ms  = LB_RETRY_MIN_MS;
+        }
+    }
+}
+
+// Loads the queue and cached top scores and starts syncing, once NVS is up.
+bool leaderboard_init() {
+    if (!game_nvs || !CONFIG_FBIRD_LEADERBOARD_URL[0]) return false;
+    
+    // Persisted state, both may be missing.
+    size_t size = sizeof(queue);
+    if (!nvs_get_blob(game_nvs, LB_QUEUE_KEY, queue, &size)) {
+        queue_len = size / sizeof(lb_run_t);
+    }
+    size = sizeof(top);
+    if (nvs_get_blob(game_nvs, LB_TOP_KEY, &top, &size) || size != sizeof(top) || top.count > LB_TOP) {
+        memset(&top, 0, sizeof(top));
+    }
+    top_version = 1;
+    
+    // Use the name set in the launcher, if any.
+    nvs_handle_t owner;
+    if (!nvs_open("owner", NVS_READONLY, &owner)) {
+        size = sizeof(name);
+        char temp[LB_NAME_LEN];
+        if (!nvs_get_str(owner, "nickname", temp, &size)) strcpy(name, temp);
+        nvs_close(owner);
+    }
+    
+    lock      = xSemaphoreCreateMutex();
+    submitted = xQueueCreate(LB_SUBMIT_MAX, sizeof(lb_run_t));
+    if (!lock || !submitted) return false;
+    return xTaskCreatePinnedToCore(lb_task, "leaderboard", LB_STACK, NULL, tskIDLE_PRIORITY + 1, &sync_task, LB_CORE) == pdPASS;
+}
+
+// Queues a finished run for upload, never blocks.
+void leaderboard_submit(uint64_t score) {
+    if (!sync_task || !score) return;
+    lb_run_t run = {
+        .score = score,
+        .id    = esp_random(),
+    };
+    if (!xQueueSend(submitted, &run, 0)) ESP_LOGW(TAG, "Too many runs submitted at once, dropping one.");
+}
+
+// Tells whether the player idles in the menu, syncs only happen then.
+void leaderboard_idle(bool idle) {
+    if (!idle) {
+        atomic_store(&idle_since, 0);
+    } else if (!atomic_load(&idle_since)) {
+        // Never 0, which means not idle.
+        atomic_store(&idle_since, esp_timer_get_time() | 1);
+    }
+}
+
+// Copies the cached top scores if they changed, never blocks. Returns true if out was updated.
+bool leaderboard_top(lb_top_t *out) {
+    static uint32_t seen_version;
+    if (!lock || !xSemaphoreTake(lock, 0)) return false;
+    bool changed = seen_version != top_version;
+    if (changed) {
+        *out = top;
+        seen_version = top_version;
+    }
+    xSemaphoreGive(lock);
+    return changed;
+}
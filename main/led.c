@@ -0,0 +1,162 @@
+
+#include "led.h"
+#include "ws2812.h"
+#include "driver/gpio.h"
+#include "freertos/task.h"
+#include "esp_timer.h"
+
+static const char *TAG = "led";
+
+typedef struct {
+    // What happened.
+    led_event_type_t type;
+    // Colour that goes with the event, if any.
+    pax_col_t        color;
+    // When it happened, to measure the latency.
+    int64_t          time;
+} led_event_t;
+
+// Queue of events, written only by the simulation and read only by the LED task.
+static led_event_t      queue[LED_QUEUE];
+// Number of events ever queued.
+static _Atomic uint32_t queue_head;
+// Number of events ever taken out.
+static _Atomic uint32_t queue_tail;
+// The LED task, woken up for new events.
+static TaskHandle_t     led_task_handle;
+
+// Colours of the LEDs, in the GRB order the LEDs take.
+static uint8_t leds[LED_COUNT * 3];
+
+// Queues an event for the effects task, never blocks. Only the simulation may call this.
+void led_event(led_event_type_t type, pax_col_t color) {
+    if (!led_task_handle) return;
+    uint32_t head = atomic_load_explicit(&queue_head, memory_order_relaxed);
+    // LEDs are cosmetic, drop the event if the queue is full.
+    if (head - atomic_load_explicit(&queue_tail, memory_order_acquire) >= LED_QUEUE) return;
+    queue[head % LED_QUEUE] = (led_event_t) {
+        .type  = type,
+        .color = color,
+        .time  = esp_timer_get_time(),
+    };
+    atomic_store_explicit(&queue_head, head + 1, memory_order_release);
+    xTaskNotifyGive(led_task_handle);
+}
+
+// Takes the oldest event out of the queue, returns false if there is none.
+static bool led_take(led_event_t *out) {
+    uint32_t tail = atomic_load_explicit(&queue_tail, memory_order_relaxed);
+    if (tail == atomic_load_explicit(&queue_head, memory_order_acquire)) return false;
+    *out = queue[tail % LED_QUEUE];
+    atomic_store_explicit(&queue_tail, tail + 1, memory_order_release);
+    return true;
+}
+
+// Sets an LED to a colour at a brightness from 0 to 1.
+static void led_set(int led, pax_col_t color, float brightness) {
+    float scale = brightness * LED_BRIGHTNESS / 255;
+    leds[led*3]   = ((color >> 8)  & 0xff) * scale;
+    leds[led*3+1] = ((color >> 16) & 0xff) * scale;
+    leds[led*3+2] = ( color        & 0xff) * scale;
+}
+
+// Runs the effects, sleeping whenever nothing is animating.
+static void led_task(void *args) {
+    // When each effect started, 0 if it isn't running.
+    int64_t   flash_start = 0;
+    int64_t   death_start = 0;
+    int64_t   pulse_start = 0;
+    pax_col_t pulse_color = 0;
+    // Worst time from event to LEDs, reported when the game ends.
+    int64_t   max_latency = 0;
+    
+    while (1) {
+        // Sleep until the next frame, or until an event when idle.
+        bool animating = flash_start || death_start || pulse_start;
+        ulTaskNotifyTake(pdTRUE, animating ? pdMS_TO_TICKS(LED_FRAME_MS) : portMAX_DELAY);
+        int64_t now = esp_timer_get_time();
+        
+        // Handle new events.
+        led_event_t event;
+        int64_t oldest = 0;
+        while (led_take(&event)) {
+            if (!oldest) oldest = event.time;
+            if (event.type == LED_SCORE) {
+                flash_start = now;
+            } else if (event.type == LED_DEATH) {
+                death_start = now;
+                pulse_start = 0;
+            } else if (event.type == LED_VARIANT) {
+                pulse_start = now;
+                pulse_color = event.color;
+            } else if (event.type == LED_OFF) {
+                flash_start = 0;
+                death_start = 0;
+                pulse_start = 0;
+                ESP_LOGI(TAG, "Worst event to LED latency %lld us.", (long long) max_latency);
+                max_latency = 0;
+            }
+        }
+        
+        // Pulse in the pole colour.
+        for (int i = 0; i < LED_COUNT; i++) {
+            if (pulse_start) {
+                float phase = (now - pulse_start) / 1000 % LED_PULSE_MS / (float) LED_PULSE_MS;
+                led_set(i, pulse_color, 0.35f + 0.25f * sinf(phase * 2 * M_PI_F));
+            } else {
+                led_set(i, 0, 0);
+            }
+        }
+        
+        // White flash on score, on top of the pulse.
+        if (flash_start) {
+            int64_t age = (now - flash_start) / 1000;
+            if (age >= LED_FLASH_MS) {
+                flash_start = 0;
+            } else {
+                float part = 1 - age / (float) LED_FLASH_MS;
+                for (int i = 0; i < LED_COUNT; i++) {
+                    led_set(i, 0xffffff, part);
+                }
+            }
+        }
+        
+        // On death, red sweeps across the LEDs from the first frame and then fades.
+        if (death_start) {
+            int64_t age = (now - death_start) / 1000;
+            if (age >= LED_DEATH_MS) {
+                death_start = 0;
+            } else {
+                float part  = age / (float) LED_DEATH_MS;
+                float sweep = part * 2 * LED_COUNT;
+                for (int i = 0; i < LED_COUNT; i++) {
+                    float lit = sweep >= i ? 1 - part : 0;
+                    led_set(i, 0xff0000, lit);
+                }
+            }
+        }
+        
+        ws2812_send_data(leds, sizeof(leds));
+        if (oldest && esp_timer_get_time() - oldest > max_latency) {
+            max_latency = esp_timer_get_time() - oldest;
+        }
+    }
+}
+
+// Starts the LEDs and the effects task.
+bool led_init() {
+    // The LEDs' power is switched separately.
+    gpio_set_direction(GPIO_LED_ENABLE, GPIO_MODE_OUTPUT);
+    gpio_set_level(GPIO_LED_ENABLE, 1);
+    esp_err_t res = ws2812_init(GPIO_LED_DATA);
+    if (res) {
+        ESP_LOGE(TAG, "Failed to start the LEDs: %s", esp_err_to_name(res));
+        return false;
+    }
+    
+    // Start dark.
+    ws2812_send_data(leds, sizeof(leds));
+    // Below the game on the same core, so a slow send can't delay a simulation step.
+    xTaskCreatePinnedToCore(led_task, "led", LED_STACK, NULL, tskIDLE_PRIORITY + 1, &led_task_handle, LED_CORE);
+    return true;
+}
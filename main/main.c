@@ -7,48 +7,107 @@ static uint64_t priv_hiscore;
 const pax_font_t *font_big;
 const pax_font_t *font_small;
 nvs_handle_t game_nvs;
-pax_buf_t buf;
 xQueueHandle buttonQueue;
 
 static const char *TAG = "main";
 bool debug_state = false;
 
-// Flush the buffer to screen.
+// Flush the scene to screen.
 void disp_flush() {
-    ili9341_write(get_ili9341(), buf.buf);
+    comp_flush();
+    boot_first_frame();
+}
+
+// Layer: covers the screen in a color.
+static void layer_fill(pax_buf_t *gfx, const layer_t *layer) {
+    pax_draw_rect(gfx, *(const pax_col_t *) layer->args, 0, 0, SCREEN_WIDTH, SCREEN_HEIGHT);
 }
 
 // Exit to the launcher.
 void exit_to_launcher() {
     REG_WRITE(RTC_CNTL_STORE0_REG, 0);
-    for (int i = 0; i < 10; i++) {
-        pax_simple_rect(&buf, 0x3fffffff, 0, 0, buf.width, buf.height);
-        disp_flush();
-    }
+    // A single white frame, the launcher takes over from there.
+    static const pax_col_t white = 0xffffffff;
+    comp_clear();
+    comp_add(0, SCREEN_HEIGHT, layer_fill, NULL, &white);
+    disp_flush();
     esp_restart();
 }
 
 
 
+// Initialises everything that the first frame doesn't need.
+static void boot_background(void *args) {
+    // Init NVS, the high score shows up once this is done.
+    nvs_flash_init();
+    nvs_handle_t handle;
+    esp_err_t res = nvs_open("robotman-app", NVS_READWRITE, &handle);
+    if (!res) game_nvs = handle;
+    boot_mark("nvs");
+    
+    // Mount FAT, the game runs without a ghost or theme when this fails.
+    if (storage_mount()) {
+        boot_mark("fat");
+        // Themes replace builtin art without a rebuild.
+        resource_load_pack(PACK_PATH);
+        boot_mark("pack");
+    }
+    
+    // Leaderboard, only when a server is configured.
+    if (leaderboard_init()) boot_mark("leaderboard");
+    
+    // Init audio, the game is still playable without it.
+    if (!audio_init()) {
+        ESP_LOGW(TAG, "Continuing without audio.");
+    }
+    boot_mark("audio");
+    
+    // Init LEDs, they're only decoration.
+    if (!led_init()) {
+        ESP_LOGW(TAG, "Continuing without LEDs.");
+    }
+    boot_mark("leds");
+    
+    // Telemetry and the ghost only record once FAT is up.
+    telemetry_init();
+    if (!ghost_init()) {
+        ESP_LOGW(TAG, "Continuing without a ghost.");
+    }
+    
+    vTaskDelete(NULL);
+}
+
+// Init (but not connect to) WiFi, the first time it is needed.
+void wifi_lazy_init() {
+    static bool initialised = false;
+    if (!initialised) {
+        wifi_init();
+        initialised = true;
+        boot_mark("wifi");
+    }
+}
+
 void app_main() {
+    boot_mark("start");
+    
     // Init HW.
     bsp_init();
+    boot_mark("bsp");
     bsp_rp2040_init();
     buttonQueue = get_rp2040()->queue;
+    boot_mark("rp2040");
+    
+    // The rest of the boot happens while the main menu shows.
+    xTaskCreatePinnedToCore(boot_background, "boot", BOOT_STACK, NULL, 1, NULL, BOOT_CORE);
     
     // Init GFX.
-    pax_buf_init(&buf, NULL, 320, 240, PAX_BUF_16_565RGB);
-    pax_enable_multicore(1);
+    if (!comp_init()) {
+        ESP_LOGE(TAG, "Failed to initialise graphics.");
+        esp_restart();
+    }
     font_big   = pax_get_font("permanentmarker");
     font_small = pax_get_font("saira regular");
-    
-    // Init NVS.
-    nvs_flash_init();
-    esp_err_t res = nvs_open("robotman-app", NVS_READWRITE, &game_nvs);
-    if (res) game_nvs = 0;
-    
-    // Init (but not connect to) WiFi.
-    wifi_init();
+    boot_mark("gfx");
     
     mainmenu();
 }
@@ -58,11 +117,20 @@ void app_main() {
 // Gets or reads from NVS, the high score.
 uint64_t get_hiscore() {
     static bool     read  = false;
-    if (!game_nvs) return 0;
+    // NVS may still be starting in the background.
+    if (!game_nvs) return priv_hiscore;
     
     if (!read) {
-        esp_err_t res = nvs_get_u64(game_nvs, "fbird_hiscore", &priv_hiscore);
-        if (res) priv_hiscore = 0;
+        uint64_t stored;
+        esp_err_t res = nvs_get_u64(game_nvs, "fbird_hiscore", &stored);
+        if (res) stored = 0;
+        read = true;
+        // A run may have finished before NVS was up, keep the better of the two.
+        if (priv_hiscore > stored) {
+            set_hiscore(priv_hiscore);
+        } else {
+            priv_hiscore = stored;
+        }
     }
     
     return priv_hiscore;
@@ -71,6 +139,8 @@ uint64_t get_hiscore() {
 // Update in NVS, the new high score.
 void set_hiscore(uint64_t newscore) {
     priv_hiscore = newscore;
+    // Written by get_hiscore once NVS is up.
+    if (!game_nvs) return;
     esp_err_t res = nvs_set_u64(game_nvs, "fbird_hiscore", newscore);
     nvs_commit(game_nvs);
 }
@@ -89,9 +159,178 @@ const char *text_hiscore() {
 }
 
 // Draws a title and optional subtitle in the middle of the screen.
-void draw_title(pax_col_t col, const char *title, const char *subtitle) {
-    pax_center_text(&buf, col, font_big, 35, buf.width/2, buf.height/2-35, title);
-    pax_center_text(&buf, col, font_small, 18, buf.width/2, buf.height/2, subtitle);
+void draw_title(pax_buf_t *gfx, pax_col_t col, const char *title, const char *subtitle) {
+    pax_center_text(gfx, col, font_big, 35, SCREEN_WIDTH/2, SCREEN_HEIGHT/2-35, title);
+    pax_center_text(gfx, col, font_small, 18, SCREEN_WIDTH/2, SCREEN_HEIGHT/2, subtitle);
+}
+
+
+
+// Layer: the background.
+static void layer_background(pax_buf_t *gfx, const layer_t *layer) {
+    draw_background(gfx);
+}
+
+// Layer: the ground.
+static void layer_ground(pax_buf_t *gfx, const layer_t *layer) {
+    draw_ground(gfx);
+}
+
+// Layer: a single pole.
+static void layer_pole(pax_buf_t *gfx, const layer_t *layer) {
+    draw_pole(gfx, (bard_t *) layer->ctx, (pole_t *) layer->args);
+}
+
+// Layer: the bard.
+static void layer_bard(pax_buf_t *gfx, const layer_t *layer) {
+    draw_bard(gfx, (bard_t *) layer->ctx);
+}
+
+// Layer: the best run's ghost.
+static void layer_ghost(pax_buf_t *gfx, const layer_t *layer) {
+    const frame_t *frame = layer->args;
+    draw_ghost(gfx, frame->ghost_y, frame->ghost_angle);
+}
+
+// Layer: all particles.
+static void layer_particles(pax_buf_t *gfx, const layer_t *layer) {
+    const frame_t *frame = layer->args;
+    draw_particles(gfx, (bard_t *) layer->ctx, frame->particles, frame->num_particles);
+}
+
+// Layer: a title and subtitle in the middle of the screen.
+static void layer_title(pax_buf_t *gfx, const layer_t *layer) {
+    draw_title(gfx, 0xff000000, layer->ctx, layer->args);
+}
+
+// Layer: a line of help text at the bottom of the screen.
+static void layer_hint(pax_buf_t *gfx, const layer_t *layer) {
+    pax_center_text(
+        gfx, 0xff000000, font_small, 18, SCREEN_WIDTH/2, SCREEN_HEIGHT-18,
+        layer->args
+    );
+}
+
+// Layer: the score at the top of the screen.
+static void layer_score(pax_buf_t *gfx, const layer_t *layer) {
+    const pax_buf_t *cache = layer->ctx;
+    if (cache) {
+        pax_draw_image(gfx, (pax_buf_t *) cache, (SCREEN_WIDTH - cache->width) / 2, 5);
+    } else {
+        pax_center_text(gfx, 0xff000000, font_big, 35, SCREEN_WIDTH/2, 5, layer->args);
+    }
+}
+
+// Gets the score rendered to an image, which is redrawn at most every text_interval frames.
+static pax_buf_t *score_cache(uint64_t score) {
+    static pax_buf_t cache;
+    static bool      cache_ready;
+    static uint64_t  cached_score = -1;
+    static int       frames_since;
+    
+    if (!cache_ready) {
+        void *mem = mem_alloc(MEM_RESOURCES, SCORE_CACHE_WIDTH * SCORE_CACHE_HEIGHT * sizeof(uint32_t));
+        // Draw the text directly if there's no memory for it.
+        if (!mem) return NULL;
+        pax_buf_init(&cache, mem, SCORE_CACHE_WIDTH, SCORE_CACHE_HEIGHT, PAX_BUF_32_8888ARGB);
+        cache_ready = true;
+    }
+    
+    frames_since ++;
+    if (score != cached_score && frames_since >= quality()->text_interval) {
+        char temp[16];
+        snprintf(temp, 16, "%lld", score);
+        pax_background(&cache, 0x00000000);
+        pax_center_text(&cache, 0xff000000, font_big, 35, SCORE_CACHE_WIDTH/2, 0, temp);
+        cached_score = score;
+        frames_since = 0;
+    }
+    return &cache;
+}
+
+// Adds the background and ground to the scene.
+static void scene_add_background() {
+    comp_add(0, SCREEN_HEIGHT, layer_background, NULL, NULL);
+    comp_add(SCREEN_HEIGHT - GROUND_HEIGHT, SCREEN_HEIGHT, layer_ground, NULL, NULL);
+}
+
+// Adds the bard to the scene.
+static void scene_add_bard(const bard_t *bard) {
+    comp_add(bard->y - BARD_MARGIN, bard->y + BARD_MARGIN, layer_bard, bard, NULL);
+}
+
+// Adds a title and subtitle to the scene.
+static void scene_add_title(const char *title, const char *subtitle) {
+    comp_add(SCREEN_HEIGHT/2-35, SCREEN_HEIGHT/2+18, layer_title, title, subtitle);
+}
+
+// Layer: the top scores, below the title.
+static void layer_leaderboard(pax_buf_t *gfx, const layer_t *layer) {
+    const lb_top_t *lb = layer->args;
+    for (int i = 0; i < lb->count && i < LB_MENU_ROWS; i++) {
+        char temp[48];
+        snprintf(temp, 48, "%d. %s  %lld", i + 1, lb->entries[i].name, lb->entries[i].score);
+        pax_center_text(gfx, 0xff000000, font_small, 18, SCREEN_WIDTH/2, layer->top + i * 18, temp);
+    }
+}
+
+// Adds the cached top scores to the scene.
+static void scene_add_leaderboard(const lb_top_t *lb) {
+    int rows = lb->count < LB_MENU_ROWS ? lb->count : LB_MENU_ROWS;
+    if (rows) comp_add(SCREEN_HEIGHT/2+25, SCREEN_HEIGHT/2+25 + rows * 18, layer_leaderboard, NULL, lb);
+}
+
+// Adds a line of help text to the scene.
+static void scene_add_hint(const char *hint) {
+    comp_add(SCREEN_HEIGHT-18, SCREEN_HEIGHT, layer_hint, NULL, hint);
+}
+
+
+
+// Builds the main menu scene around a dummy bard.
+void scene_menu(const bard_t *dummy, const char *subtitle) {
+    comp_clear();
+    scene_add_background();
+    scene_add_bard(dummy);
+    scene_add_title("Floppy Bard", subtitle);
+    scene_add_hint("🅷Exit  🅰Start the game");
+}
+
+// Builds the in-game scene for a frame.
+void scene_game(const frame_t *frame) {
+    const bard_t *bard = &frame->bard;
+    
+    comp_clear();
+    scene_add_background();
+    for (size_t i = 0; i < frame->num_poles; i++) {
+        const pole_t *cur = &frame->poles[i];
+        // Skip poles that aren't visible.
+        float x = cur->x - bard->level_pos;
+        if (x >= SCREEN_WIDTH || x <= -POLE_WIDTH) continue;
+        comp_add(0, SCREEN_HEIGHT - GROUND_HEIGHT, layer_pole, bard, cur);
+    }
+    // The ghost goes behind the bard.
+    if (frame->ghost) {
+        comp_add(frame->ghost_y - BARD_MARGIN, frame->ghost_y + BARD_MARGIN, layer_ghost, NULL, frame);
+    }
+    scene_add_bard(bard);
+    if (frame->num_particles && quality()->particles) {
+        int top, bottom;
+        particle_bounds(frame->particles, frame->num_particles, &top, &bottom);
+        comp_add(top, bottom, layer_particles, bard, frame);
+    }
+    
+    // Text
+    if (bard->paused) {
+        scene_add_title("Paused", NULL);
+        scene_add_hint("🅰Jump and unpause  🅱Unpause");
+    } else if (bard->alive && bard->score < 2) {
+        scene_add_hint("🅰Jump  🅱Pause");
+    }
+    // Score, the text lives in a static so that it outlasts this call.
+    static char temp[16];
+    snprintf(temp, 16, "%lld", bard->score);
+    comp_add(5, 40, layer_score, score_cache(bard->score), temp);
 }
 
 
@@ -104,12 +343,12 @@ void render_pole(bard_t *bard, pole_t *pole) {
     float gap = pole->gap;
     
     // Test whether the POLE is on the screen to the RIGHT.
-    if (pole->x - bard->level_pos < buf.width) {
+    if (pole->x - bard->level_pos < SCREEN_WIDTH) {
         pole->onscreen = true;
     }
     
     // Test whether POLE is approximately IN RANGE.
-    if (x > HITBOX_RADIUS - POLE_LENIENCE) return;
+    if (x > COLL_RADIUS) return;
     
     // Test whether POLE is off screen to the LEFT.
     if (pole->x - bard->level_pos < -POLE_WIDTH) {
@@ -118,10 +357,12 @@ void render_pole(bard_t *bard, pole_t *pole) {
     }
     
     // Test whether POLE is approximately IN RANGE.
-    if (x < POLE_LENIENCE - POLE_WIDTH - HITBOX_RADIUS) {
+    if (x < -POLE_WIDTH - COLL_RADIUS) {
         if (!pole->counted) {
             pole->counted = true;
             bard->score ++;
+            audio_play(SFX_SCORE);
+            led_event(LED_SCORE, 0);
         }
         return;
     }
@@ -130,11 +371,12 @@ void render_pole(bard_t *bard, pole_t *pole) {
     bool hits_bottom = false;
     bool hits_edge   = false;
     
-    // Center collisions.
-    if (bard->y <= y - gap + HITBOX_RADIUS - POLE_LENIENCE) {
+    // Center collisions, pixel accurate against the bard's rotated shape.
+    int hits = collision_pole(bard, pole);
+    if (hits & COLL_TOP) {
         collision   = true;
         hits_top    = true;
-    } else if (bard->y >= y - HITBOX_RADIUS + POLE_LENIENCE) {
+    } else if (hits & COLL_BOTTOM) {
         collision   = true;
         hits_bottom = true;
     }
@@ -145,18 +387,26 @@ void render_pole(bard_t *bard, pole_t *pole) {
     
     // Death.
     if (collision) {
+        bool was_alive = bard->alive;
+        if (bard->alive) {
+            audio_play(SFX_DEATH);
+            led_event(LED_DEATH, 0);
+        }
         bard->alive = false;
         if (hits_edge) {
-            // Bounce off the edge.
-            bard->x   = pole->x - bard->level_pos + POLE_LENIENCE - HITBOX_RADIUS-0.1;
-            bard->vel = 0.1;
-            particle_spread(
-                PARTICLE_DUST(pole->x, bard->y),
-                10,
-                0, 10, REPEL_RECTANGULAR
-            );
+            // Push the bard out by its mask's real extent, so the next step doesn't hit again.
+            bard->x = floorf(pole->x - bard->level_pos) - collision_right(bard);
+            // Bounce off the edge only once, the mask grows while the bard turns as it falls.
+            if (was_alive) {
+                bard->vel = 0.1f;
+                particle_spread(
+                    PARTICLE_DUST(pole->x, bard->y),
+                    10,
+                    0, 10, REPEL_RECTANGULAR
+                );
+            }
         } else if (hits_top) {
-            bard->y   = pole->y - pole->gap - POLE_LENIENCE + HITBOX_RADIUS;
+            bard->y   = y - gap + HITBOX_RADIUS;
             // Bounce off the ceiling.
             bard->vel = -JUMP_HEIGHT;
             particle_spread(
@@ -165,9 +415,9 @@ void render_pole(bard_t *bard, pole_t *pole) {
                 10, 0, REPEL_RECTANGULAR
             );
         } else if (hits_bottom) {
-            bard->y = pole->y + POLE_LENIENCE - HITBOX_RADIUS;
+            bard->y = y - HITBOX_RADIUS;
             // Bounce off the floor.
-            bard->vel *= -0.5;
+            bard->vel *= -0.5f;
             bard->vel += GRAVITY*3;
             if (bard->vel > 0) bard->vel = 0;
             else {
@@ -183,20 +433,28 @@ void render_pole(bard_t *bard, pole_t *pole) {
 
 // Main menu loop.
 void mainmenu() {
+    bool checked_save = false;
+    // Top scores as last seen, the sync task updates them in the background.
+    static lb_top_t lb;
     while (1) {
+        // Resume a suspended game as soon as NVS is up.
+        if (!checked_save && game_nvs) {
+            checked_save = true;
+            if (save_exists()) ingame(true);
+        }
+        
         uint64_t now = esp_timer_get_time() / 1000;
-        draw_background();
         bard_t dummy;
-        dummy.x      = 50;
-        dummy.y      = 50+sinf(now * M_PI / 2000)*10;
-        dummy.angle  = sinf(now*M_PI/1000)*M_PI/32;
+        dummy.x      = BARD_X;
+        dummy.y      = 50+sinf(now * M_PI_F / 2000)*10;
+        dummy.angle  = sinf(now*M_PI_F/1000)*M_PI_F/32;
         dummy.paused = false;
-        draw_bard(&dummy);
-        draw_title(0xff000000, "Floppy Bard", text_hiscore());
-        pax_center_text(
-            &buf, 0xff000000, font_small, 18, buf.width/2, buf.height-18,
-            "🅷Exit  🅰Start the game"
-        );
+        
+        // The leaderboard only turns the radio on while the player sits in the menu.
+        leaderboard_idle(true);
+        scene_menu(&dummy, text_hiscore());
+        leaderboard_top(&lb);
+        scene_add_leaderboard(&lb);
         disp_flush();
         
         rp2040_input_message_t msg;
@@ -205,220 +463,43 @@ void mainmenu() {
                 exit_to_launcher();
             } else if (msg.input == RP2040_INPUT_BUTTON_ACCEPT) {
                 // Start the game.
-                ingame();
+                ingame(false);
+            } else if (msg.input == RP2040_INPUT_BUTTON_SELECT) {
+                // Check rendering against the golden hashes, without the radio skewing times.
+                leaderboard_idle(false);
+                render_check();
             }
         }
     }
 }
 
 // Level loop.
-void ingame() {
-    uint64_t exit_time = 0;
-    bard_t bard;
-    
-    particle_clear();
-    
-    // Set initial position equal to main menu.
-    uint64_t start    = esp_timer_get_time() / 1000;
-    uint64_t now      = start;
-    bard.x            = 50;
-    bard.y            = 50 + sinf(now * M_PI / 2000) * 10;
-    bard.angle        = sinf(now * M_PI / 1000) * M_PI / 32;
-    // Start unpaused while jumping.
-    bard.vel          = JUMP_HEIGHT;
-    bard.paused       = false;
-    bard.alive        = true;
-    // Level position.
-    bard.level_pos    = 0;
-    bard.level_vel    = 5;
-    // Difficulty curves.
-    bard.pole_dist    = INITIAL_POLE_DIST;
-    bard.pole_gap     = INITIAL_POLE_GAP;
-    bard.next_diff    = DIFF_INC_EVERY;
-    // Miscellaneous.
-    bard.pole_variant = random_variant(-1);
-    bard.score        = 0;
-    bard.num_poles    = 1;
-    
-    // Initial pole.
-    pole_t *poles  = malloc(sizeof(pole_t));
-    *poles = (pole_t) {
-        .prev      = NULL,
-        .next      = NULL,
-        .x         = 400,
-        .y         = 100,
-        .gap       = bard.pole_gap,
-        .variant   = bard.pole_variant,
-        .counted   = false,
-        .offscreen = false,
-        .onscreen  = false,
-    };
+void ingame(bool resume) {
+    // No syncs while playing.
+    leaderboard_idle(false);
+    // The simulation runs on the other core, this one only draws.
+    game_start(resume);
+    telemetry_start();
+    int64_t last_frame = esp_timer_get_time();
     
     while (1) {
-        // Get current time for reference.
-        now = esp_timer_get_time() / 1000;
-        
-        if (!bard.paused) {
-            // Apply physics.
-            bard.y   += bard.vel;
-            bard.vel += GRAVITY;
-            
-            // Maximum height.
-            if (bard.y < -40) {
-                bard.y = -40;
-            }
-            
-            // Minimum height.
-            if (bard.y > buf.height - 30 - HITBOX_RADIUS) {
-                bard.y = buf.height - 30 - HITBOX_RADIUS;
-                // Bounce off the floor.
-                bard.vel *= -0.5;
-                bard.vel += GRAVITY*3;
-                if (bard.vel > 0) bard.vel = 0;
-                else {
-                    particle_spread(
-                        PARTICLE_DUST(bard.x + bard.level_pos, buf.height - 30),
-                        10,
-                        10, 0, REPEL_RECTANGULAR
-                    );
-                }
-                // Game over.
-                bard.alive = false;
-            }
-            
-            // Bard angle.
-            if (fabsf(bard.vel) >= 0.3) {
-                float angle_target = M_PI / 6 * bard.vel / JUMP_HEIGHT + M_PI/12;
-                float angle_error  = angle_target - bard.angle;
-                bard.angle = angle_target - 0.7 * angle_error;
-            }
-            
-            // Level physics.
-            if (bard.alive) {
-                bard.level_pos += bard.level_vel;
-                
-                // Check whether a pole must be removed.
-                if (poles->offscreen) {
-                    // Unlink it from the list.
-                    void *to_free = poles;
-                    poles->next->prev = NULL;
-                    poles = poles->next;
-                    free(to_free);
-                }
-            }
-            
-            for (pole_t *cur = poles; cur; cur = cur->next) {
-                render_pole(&bard, cur);
-                
-                // Check whether a pole must be added.
-                if (!cur->next && cur->onscreen && bard.alive) {
-                    // Add the next pole.
-                    pole_t *next = malloc(sizeof(pole_t));
-                    *next = (pole_t) {
-                        .prev      = cur,
-                        .next      = NULL,
-                        .x         = cur->x + POLE_WIDTH + bard.pole_dist,
-                        .gap       = bard.pole_gap,
-                        .variant   = bard.pole_variant,
-                        .counted   = false,
-                        .offscreen = false,
-                        .onscreen  = false,
-                    };
-                    // Randomise it's vertical position.
-                    next->y = esp_random() / (float) UINT32_MAX;
-                    const float bottom = buf.height - 30 - POLE_LENIENCE * 2;
-                    const float top    = POLE_LENIENCE * 2 + next->gap;
-                    next->y = top + (bottom - top) * next->y;
-                    // Link it to the list.
-                    cur->next = next;
-                    // Keep track of number of poles added.
-                    bard.num_poles ++;
-                }
-            }
-            
-            // Particle physics.
-            render_particles(&bard);
-        }
-        
-        // Draw scene.
-        draw_background();
-        for (pole_t *cur = poles; cur; cur = cur->next) {
-            draw_pole(&bard, cur);
+        const frame_t *frame = game_acquire();
+        if (frame->finished) telemetry_end();
+        if (frame->finished && frame->suspended) {
+            // Restarting would cut the session's last records off.
+            if (!telemetry_wait(TELEMETRY_EXIT_MS)) ESP_LOGW(TAG, "Leaving before telemetry was written.");
+            exit_to_launcher();
         }
-        draw_bard(&bard);
-        draw_particles(&bard);
+        if (frame->finished) return;
         
-        // Text
-        if (bard.paused) {
-            draw_title(0xff000000, "Paused", NULL);
-            pax_center_text(
-                &buf, 0xff000000, font_small, 18, buf.width/2, buf.height-18,
-                "🅰Jump and unpause  🅱Unpause"
-            );
-        } else if (bard.alive && bard.score < 2) {
-            pax_center_text(
-                &buf, 0xff000000, font_small, 18, buf.width/2, buf.height-18,
-                "🅰Jump  🅱Pause"
-            );
-        }
-        // Score.
-        char temp[16];
-        snprintf(temp, 16, "%lld", bard.score);
-        pax_center_text(&buf, 0xff000000, font_big, 35, buf.width/2, 5, temp);
+        scene_game(frame);
         disp_flush();
+        mem_mark_frame();
         
-        // Increasing difficulty.
-        if (bard.num_poles >= bard.next_diff) {
-            bard.next_diff += DIFF_INC_EVERY;
-            bard.pole_dist += (MIN_POLE_DIST - bard.pole_dist) * DIFF_FACTOR;
-            bard.pole_gap  += (MIN_POLE_GAP  - bard.pole_gap ) * DIFF_FACTOR;
-            bard.pole_variant = random_variant(bard.pole_variant);
-        }
-        
-        // Game over delay.
-        if (!bard.alive) {
-            if (!exit_time && bard.vel == 0) {
-                // Set exit timer.
-                exit_time = esp_timer_get_time() / 1000 + EXIT_TIME;
-                // Update high score.
-                if (bard.score > get_hiscore()) set_hiscore(bard.score);
-            } else if (exit_time && now >= exit_time) {
-                // Delete the linked list.
-                while (poles) {
-                    void *mem = poles;
-                    poles = poles->next;
-                    free(mem);
-                }
-                return;
-            }
-        }
-        
-        // Input handling.
-        rp2040_input_message_t msg;
-        if (xQueueReceive(buttonQueue, &msg, 1) && msg.state) {
-            if (msg.input == RP2040_INPUT_BUTTON_ACCEPT && bard.alive) {
-                // Jump.
-                bard.vel    = JUMP_HEIGHT;
-                bard.paused = false;
-            } else if (msg.input == RP2040_INPUT_BUTTON_BACK && bard.alive) {
-                // Pause.
-                bard.paused = !bard.paused;
-            } else if (msg.input == RP2040_INPUT_JOYSTICK_UP && DO_DEBUG(&bard)) {
-                // Debug: Move up.
-                bard.y -= 5;
-            } else if (msg.input == RP2040_INPUT_JOYSTICK_DOWN && DO_DEBUG(&bard)) {
-                // Debug: Move down.
-                bard.y += 5;
-            } else if (msg.input == RP2040_INPUT_JOYSTICK_LEFT && DO_DEBUG(&bard)) {
-                // Debug: Move left.
-                bard.level_pos -= 5;
-            } else if (msg.input == RP2040_INPUT_JOYSTICK_RIGHT && DO_DEBUG(&bard)) {
-                // Debug: Move right.
-                bard.level_pos += 5;
-            } else if (msg.input == RP2040_INPUT_JOYSTICK_PRESS) {
-                // Enable/disable debug.
-                debug_state = !debug_state;
-            }
-        }
+        // Let quality follow the frame time.
+        int64_t now = esp_timer_get_time();
+        quality_frame(now - last_frame);
+        telemetry_frame(frame, now - last_frame);
+        last_frame = now;
     }
 }
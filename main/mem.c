@@ -0,0 +1,120 @@
+
+#include "mem.h"
+#include "esp_heap_caps.h"
+#include "string.h"
+#include "freertos/task.h"
+
+static const char *TAG = "memory";
+
+typedef struct mem_header mem_header_t;
+typedef struct mem_stats mem_stats_t;
+
+// Prepended to every allocation, sized to keep the user data aligned.
+struct mem_header {
+    // The subsystem the memory belongs to.
+    uint32_t tag;
+    // The size requested by the subsystem.
+    uint32_t size;
+};
+
+struct mem_stats {
+    // Bytes currently allocated.
+    size_t   live;
+    // Most bytes allocated at any one time.
+    size_t   peak;
+    // Allocations since the last report.
+    uint32_t allocs;
+    // Allocations that failed since boot.
+    uint32_t failed;
+};
+
+static const char *const tag_names[MEM_TAG_COUNT] = {
+    [MEM_POLES]       = "poles",
+    [MEM_PARTICLES]   = "particles",
+    [MEM_RESOURCES]   = "resources",
+    [MEM_FRAMEBUFFER] = "framebuffer",
+};
+
+// Statistics per subsystem.
+static mem_stats_t  stats[MEM_TAG_COUNT];
+// Frames since the last report.
+static uint32_t     frames;
+// Protects the statistics, allocations happen on both cores.
+static portMUX_TYPE stats_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// Adds to or subtracts from the live bytes of a subsystem.
+static void mem_account(mem_tag_t tag, ssize_t delta, bool is_alloc) {
+    portENTER_CRITICAL(&stats_lock);
+    mem_stats_t *cur = &stats[tag];
+    cur->live += delta;
+    if (cur->live > cur->peak) cur->peak = cur->live;
+    if (is_alloc) cur->allocs ++;
+    portEXIT_CRITICAL(&stats_lock);
+}
+
+// Allocates memory with specific capabilities on behalf of a subsystem.
+void *mem_alloc_caps(mem_tag_t tag, size_t size, uint32_t caps) {
+    mem_header_t *mem = heap_caps_malloc(sizeof(mem_header_t) + size, caps);
+    if (!mem) {
+        portENTER_CRITICAL(&stats_lock);
+        stats[tag].failed ++;
+        portEXIT_CRITICAL(&stats_lock);
+        ESP_LOGW(TAG, "Out of memory allocating %u bytes for %s.", size, tag_names[tag]);
+        return NULL;
+    }
+    mem->tag  = tag;
+    mem->size = size;
+    mem_account(tag, size, true);
+    return mem + 1;
+}
+
+// Allocates memory on behalf of a subsystem, returns NULL when out of memory.
+void *mem_alloc(mem_tag_t tag, size_t size) {
+    return mem_alloc_caps(tag, size, MALLOC_CAP_8BIT);
+}
+
+// Frees memory from mem_alloc or mem_alloc_caps.
+void mem_free(void *ptr) {
+    if (!ptr) return;
+    mem_header_t *mem = (mem_header_t *) ptr - 1;
+    mem_account(mem->tag, -(ssize_t) mem->size, false);
+    free(mem);
+}
+
+// Accounts for memory that a subsystem allocated through another library.
+void mem_track(mem_tag_t tag, ssize_t delta) {
+    mem_account(tag, delta, false);
+}
+
+// Marks the end of a frame for the allocation rate statistics.
+void mem_mark_frame() {
+    if (++ frames >= MEM_REPORT_FRAMES) {
+        mem_report();
+    }
+}
+
+// Logs live, peak and allocation rate for all subsystems.
+void mem_report() {
+    // Copy the statistics so logging happens outside of the lock.
+    portENTER_CRITICAL(&stats_lock);
+    mem_stats_t copy[MEM_TAG_COUNT];
+    memcpy(copy, stats, sizeof(stats));
+    for (size_t i = 0; i < MEM_TAG_COUNT; i++) {
+        stats[i].allocs = 0;
+    }
+    uint32_t num_frames = frames;
+    frames = 0;
+    portEXIT_CRITICAL(&stats_lock);
+    
+    for (size_t i = 0; i < MEM_TAG_COUNT; i++) {
+        ESP_LOGI(TAG, "%-11s live %6u peak %6u allocs/frame %5.2f failed %u",
+            tag_names[i], copy[i].live, copy[i].peak,
+            num_frames ? copy[i].allocs / (float) num_frames : 0.0f,
+            copy[i].failed
+        );
+    }
+    ESP_LOGI(TAG, "Heap free: %u internal, %u total.",
+        heap_caps_get_free_size(MALLOC_CAP_INTERNAL),
+        heap_caps_get_free_size(MALLOC_CAP_8BIT)
+    );
+}
@@ -0,0 +1,69 @@
+
+#include "mixer.h"
+#include "stdbool.h"
+#include "string.h"
+
+typedef struct voice voice_t;
+
+struct voice {
+    // The next sample to play, NULL if the voice is idle.
+    const int16_t *pos;
+    // The end of the sample.
+    const int16_t *end;
+};
+
+// Voices being mixed.
+static voice_t voices[MIXER_VOICES];
+// Voice to steal next if all are busy.
+static size_t  next_steal;
+// Mixing accumulator.
+static int32_t mix[MIXER_BLOCK];
+
+// Starts a 16-bit signed mono sample on a free voice, stealing one if needed.
+void mixer_start(const int16_t *start, const int16_t *end) {
+    voice_t *voice = NULL;
+    for (size_t i = 0; i < MIXER_VOICES; i++) {
+        if (!voices[i].pos) {
+            voice = &voices[i];
+            break;
+        }
+    }
+    if (!voice) {
+        voice = &voices[next_steal];
+        next_steal = (next_steal + 1) % MIXER_VOICES;
+    }
+    voice->pos = start;
+    voice->end = end;
+}
+
+// Mixes all active voices into one block of interleaved stereo.
+void mixer_mix(int16_t out[MIXER_BLOCK * 2]) {
+    memset(mix, 0, sizeof(mix));
+    for (size_t i = 0; i < MIXER_VOICES; i++) {
+        voice_t *voice = &voices[i];
+        if (!voice->pos) continue;
+        size_t n = voice->end - voice->pos;
+        if (n > MIXER_BLOCK) n = MIXER_BLOCK;
+        for (size_t x = 0; x < n; x++) {
+            mix[x] += voice->pos[x];
+        }
+        voice->pos += n;
+        if (voice->pos >= voice->end) voice->pos = NULL;
+    }
+    // Clamp and duplicate to both channels.
+    for (size_t x = 0; x < MIXER_BLOCK; x++) {
+        int32_t sample = mix[x];
+        if (sample > INT16_MAX) sample = INT16_MAX;
+        if (sample < INT16_MIN) sample = INT16_MIN;
+        out[x*2]   = sample;
+        out[x*2+1] = sample;
+    }
+}
+
+// Whether any voice is still playing.
+bool mixer_busy() {
+    for (size_t i = 0; i < MIXER_VOICES; i++) {
+        if (voices[i].pos) return true;
+    }
+    return false;
+}
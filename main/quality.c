@@ -0,0 +1,99 @@
+
+#include "quality.h"
+#include "string.h"
+
+static const char *TAG = "quality";
+
+// Quality tiers from best to cheapest, each drops a little more.
+static const quality_t tiers[] = {
+    {
+        .name          = "full",
+        .text_interval = 1,
+        .rotate_bard   = true,
+        .particles     = true,
+        .particle_lod  = 0,
+    }, {
+        .name          = "slow text",
+        .text_interval = 4,
+        .rotate_bard   = true,
+        .particles     = true,
+        .particle_lod  = 1,
+    }, {
+        .name          = "flat bard",
+        .text_interval = 4,
+        .rotate_bard   = false,
+        .particles     = true,
+        .particle_lod  = 2,
+    }, {
+        .name          = "minimal",
+        .text_interval = 8,
+        .rotate_bard   = false,
+        .particles     = false,
+        .particle_lod  = 3,
+    }
+};
+static const int num_tiers = sizeof(tiers) / sizeof(quality_t);
+
+// Current tier, written by the renderer and read by the simulation.
+static _Atomic int tier;
+// The last frame times.
+static int64_t     window[QUALITY_WINDOW];
+// Sum of the last frame times.
+static int64_t     window_sum;
+// Position in the window of the next frame time.
+static size_t      window_pos;
+// Number of slow frames in a row.
+static int         slow_frames;
+// Number of fast frames in a row.
+static int         fast_frames;
+
+// Reports how long the last frame took, adjusting quality.
+void quality_frame(int64_t frame_us) {
+    // Rolling frame time.
+    window_sum -= window[window_pos];
+    window[window_pos] = frame_us;
+    window_sum += frame_us;
+    window_pos = (window_pos + 1) % QUALITY_WINDOW;
+    int64_t average = window_sum / QUALITY_WINDOW;
+    
+    // Lowering is quick, raising needs a lot of headroom so tiers don't flap.
+    int cur = atomic_load(&tier);
+    int next = cur;
+    if (average > FRAME_TARGET_US * 11 / 10) {
+        fast_frames = 0;
+        if (++ slow_frames >= QUALITY_DOWN_FRAMES && cur < num_tiers - 1) next = cur + 1;
+    } else if (average < FRAME_TARGET_US * 7 / 10) {
+        slow_frames = 0;
+        if (++ fast_frames >= QUALITY_UP_FRAMES && cur > 0) next = cur - 1;
+    } else {
+        slow_frames = 0;
+        fast_frames = 0;
+    }
+    
+    if (next != cur) {
+        slow_frames = 0;
+        fast_frames = 0;
+        atomic_store(&tier, next);
+        ESP_LOGI(TAG, "Average frame %lld us, quality %s -> %s.", (long long) average, tiers[cur].name, tiers[next].name);
+    }
+}
+
+// Returns to full quality and forgets past frame times.
+void quality_reset() {
+    memset(window, 0, sizeof(window));
+    window_sum  = 0;
+    window_pos  = 0;
+    slow_frames = 0;
+    fast_frames = 0;
+    atomic_store(&tier, 0);
+}
+
+// Gets the index of the current quality tier, 0 being full quality.
+int quality_tier() {
+    return atomic_load(&tier);
+}
+
+// Gets the current quality tier.
+const quality_t *quality() {
+    return &tiers[atomic_load(&tier)];
+}
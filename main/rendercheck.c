@@ -0,0 +1,197 @@
+
+#include "rendercheck.h"
+#include "main.h"
+#include "mem.h"
+#include "esp_heap_caps.h"
+#include "string.h"
+
+static const char *TAG = "rendercheck";
+
+typedef struct {
+    // Name of the scene, for logging.
+    const char *name;
+    // Whether debug hitboxes are shown.
+    bool        debug;
+    // Builds the scene.
+    void      (*build)();
+    // Expected band hashes, all zero if not recorded yet.
+    uint32_t    golden[RENDER_CHECK_BANDS];
+} scene_t;
+
+// Fixed poles shared by the in-game scenes.
+static const pole_t check_poles[] = {
+    { .x = 180, .y = 150, .gap = 90, .variant = 0, .counted = true,  .onscreen = true },
+    { .x = 430, .y = 120, .gap = 80, .variant = 1, .counted = false, .onscreen = true },
+};
+
+// Fixed bard shared by the in-game scenes.
+static const bard_t check_bard = {
+    .x         = 50,
+    .y         = 110,
+    .vel       = -3,
+    .angle     = -0.3f,
+    .alive     = true,
+    .level_pos = 100,
+    .level_vel = LEVEL_SPEED,
+    .score     = 7,
+};
+
+// Copies the fixed poles into a frame.
+static void check_frame(frame_t *frame, const bard_t *bard) {
+    memset(frame, 0, sizeof(frame_t));
+    frame->bard      = *bard;
+    frame->num_poles = sizeof(check_poles) / sizeof(pole_t);
+    memcpy(frame->poles, check_poles, sizeof(check_poles));
+}
+
+// Scene: the main menu.
+static void check_menu() {
+    static const bard_t dummy = {
+        .x     = 50,
+        .y     = 50,
+        .angle = M_PI_F / 64,
+    };
+    scene_menu(&dummy, "High score: 42");
+}
+
+// Scene: mid-game with a burst of dust.
+static void check_particles() {
+    static frame_t frame;
+    check_frame(&frame, &check_bard);
+    for (int i = 0; i < 12; i++) {
+        frame.particles[i] = PARTICLE_DUST(150 + i * 7, 60 + (i % 4) * 9);
+        frame.particles[i].age = i;
+    }
+    frame.num_particles = 12;
+    scene_game(&frame);
+}
+
+// Scene: paused, with hitboxes.
+static void check_paused() {
+    static frame_t frame;
+    check_frame(&frame, &check_bard);
+    frame.bard.paused = true;
+    scene_game(&frame);
+}
+
+// Scene: game over, the bard lies on the ground.
+static void check_gameover() {
+    static frame_t frame;
+    check_frame(&frame, &check_bard);
+    frame.bard.alive = false;
+    frame.bard.y     = SCREEN_HEIGHT - GROUND_HEIGHT - HITBOX_RADIUS;
+    frame.bard.vel   = 0;
+    frame.bard.angle = M_PI_F / 4;
+    frame.bard.score = 23;
+    scene_game(&frame);
+}
+
+// The canonical scenes. To record them, run the check from the menu on a badge, then run
+// tools/golden.py on the monitor log or on RENDER_CHECK_PATH copied off the badge.
+static const scene_t scenes[] = {
+    { .name = "menu",      .build = check_menu },
+    { .name = "particles", .build = check_particles },
+    { .name = "paused",    .build = check_paused, .debug = true },
+    { .name = "gameover",  .build = check_gameover },
+};
+static const int num_scenes = sizeof(scenes) / sizeof(scene_t);
+
+// Formats hashes the way tools/golden.py reads them.
+static void check_format_hashes(char *out, size_t size, const uint32_t *hashes) {
+    size_t len = 0;
+    for (int i = 0; i < RENDER_CHECK_BANDS; i++) {
+        len += snprintf(out + len, size - len, "0x%08x, ", (unsigned) hashes[i]);
+    }
+}
+
+// Layer: the result of the check.
+static void layer_check_result(pax_buf_t *gfx, const layer_t *layer) {
+    pax_background(gfx, 0xffffffff);
+    draw_title(gfx, 0xff000000, layer->ctx, layer->args);
+}
+
+// Renders the canonical scenes, compares them to the golden hashes and shows the result.
+// Returns the number of scenes that don't match, or -1 if none could be compared.
+int render_check() {
+    // The whole screen at once, only the check needs it so it goes in PSRAM.
+    size_t size = SCREEN_WIDTH * SCREEN_HEIGHT * sizeof(uint16_t);
+    void *mem = mem_alloc_caps(MEM_FRAMEBUFFER, size, MALLOC_CAP_SPIRAM);
+    if (!mem) {
+        ESP_LOGE(TAG, "No memory for the check buffer.");
+        return -1;
+    }
+    pax_buf_t gfx;
+    pax_buf_init(&gfx, mem, SCREEN_WIDTH, SCREEN_HEIGHT, PAX_BUF_16_565RGB);
+    
+    // Tiers and detail levels change the output, check the full one.
+    quality_reset();
+    bool debug = debug_state;
+    int  failed     = 0;
+    int  unrecorded = 0;
+    // Every scene's hashes are written, so a whole run can be recorded at once.
+    FILE *fd = storage_ready() ? fopen(RENDER_CHECK_PATH, "w") : NULL;
+    
+    for (int i = 0; i < num_scenes; i++) {
+        const scene_t *cur = &scenes[i];
+        debug_state = cur->debug;
+        cur->build();
+        
+        // The first render also loads resources, so it isn't timed.
+        comp_render(&gfx);
+        uint32_t hashes[RENDER_CHECK_BANDS];
+        golden_hash(gfx.buf, hashes);
+        int64_t start = esp_timer_get_time();
+        for (int run = 0; run < RENDER_CHECK_RUNS; run++) {
+            comp_render(&gfx);
+        }
+        int64_t time = (esp_timer_get_time() - start) / RENDER_CHECK_RUNS;
+        
+        // Compare to the golden hashes.
+        char line[RENDER_CHECK_BANDS * 12 + 1];
+        check_format_hashes(line, sizeof(line), hashes);
+        if (fd) fprintf(fd, "%s: .golden = { %s}\n", cur->name, line);
+        int differ;
+        golden_result_t result = golden_compare(cur->golden, hashes, &differ);
+        if (result == GOLDEN_UNRECORDED) {
+            ESP_LOGW(TAG, "%-10s new       %6lld us", cur->name, (long long) time);
+            ESP_LOGI(TAG, "%s: .golden = { %s}", cur->name, line);
+            unrecorded ++;
+        } else if (result == GOLDEN_FAIL) {
+            ESP_LOGE(TAG, "%-10s FAIL      %6lld us (%d bands differ)", cur->name, (long long) time, differ);
+            ESP_LOGI(TAG, "%s: .golden = { %s}", cur->name, line);
+            failed ++;
+        } else {
+            ESP_LOGI(TAG, "%-10s ok        %6lld us", cur->name, (long long) time);
+        }
+    }
+    
+    if (fd) fclose(fd);
+    debug_state = debug;
+    mem_free(mem);
+    
+    // Only scenes with golden hashes count, it never passes on nothing.
+    const char *title;
+    char temp[48];
+    if (failed) {
+        title = "Render check failed";
+        snprintf(temp, sizeof(temp), "%d of %d scenes failed", failed, num_scenes - unrecorded);
+    } else if (unrecorded == num_scenes) {
+        title = "Render check not recorded";
+        snprintf(temp, sizeof(temp), "%d scenes unrecorded", unrecorded);
+    } else if (unrecorded) {
+        title = "Render check incomplete";
+        snprintf(temp, sizeof(temp), "%d passed, %d scenes unrecorded", num_scenes - unrecorded, unrecorded);
+    } else {
+        title = "Render check passed";
+        snprintf(temp, sizeof(temp), "%d of %d scenes passed", num_scenes, num_scenes);
+    }
+    
+    // Show the result until a button is pressed.
+    comp_clear();
+    comp_add(0, SCREEN_HEIGHT, layer_check_result, title, temp);
+    disp_flush();
+    rp2040_input_message_t msg;
+    while (!xQueueReceive(buttonQueue, &msg, portMAX_DELAY) || !msg.state);
+    
+    return unrecorded == num_scenes ? -1 : failed;
+}
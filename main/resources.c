@@ -1,11 +1,15 @@
 
 #include "resources.h"
+#include "stdatomic.h"
+#include "stdlib.h"
 
 /* ==== Private typedefs ==== */
 
 static const char *TAG = "resources";
 
 typedef struct rsrc rsrc_t;
+typedef struct pack_header pack_header_t;
+typedef struct pack_entry pack_entry_t;
 
 struct rsrc {
     /* ==== Linked list ==== */
@@ -29,8 +33,43 @@ struct rsrc {
     const void *start;
     // The end location of builtin resources.
     const void *end;
+    /* ==== Packed location ==== */
+    // Offset of the resource in the pack.
+    uint32_t    offset;
+    // Size of the resource in the pack.
+    uint32_t    size;
+    // How the resource is stored, one of PACK_FORMAT_*.
+    uint16_t    format;
+    // Size of the image, for raw pixel data.
+    uint16_t    width, height;
 };
 
+// Start of a pack file, followed by the entries.
+struct pack_header {
+    // Always PACK_MAGIC.
+    uint32_t magic;
+    // Always PACK_VERSION.
+    uint16_t version;
+    // Number of entries that follow.
+    uint16_t count;
+} __attribute__((packed));
+
+// Index entry of a pack file, sorted by name.
+struct pack_entry {
+    // Name of the resource, NUL terminated.
+    char     name[PACK_NAME_LEN];
+    // Offset of the resource from the start of the pack.
+    uint32_t offset;
+    // Size of the resource.
+    uint32_t size;
+    // How the resource is stored, one of PACK_FORMAT_*.
+    uint16_t format;
+    // Size of the image.
+    uint16_t width, height;
+    // Always zero.
+    uint16_t reserved;
+} __attribute__((packed));
+
 
 
 /* ==== Resource data ==== */
@@ -55,15 +94,77 @@ static rsrc_t builtins[] = {
 };
 static const size_t num_builtins = sizeof(builtins) / sizeof(rsrc_t);
 
+// Resources in the loaded pack, sorted by name.
+static rsrc_t        *packed;
+// Number of resources in the loaded pack, set once all of them are loaded.
+static _Atomic size_t num_packed;
+
+
+
+// Size of the pixel data pax allocated for a decoded resource.
+static ssize_t resource_pixel_size(pax_buf_t *buf) {
+    return buf->width * buf->height * sizeof(uint32_t);
+}
 
+// Checks that an index entry lies within the pack and, when raw, that its size matches its pixels.
+static bool resource_entry_valid(const pack_entry_t *entry, uint32_t pack_size) {
+    if (entry->offset > pack_size || entry->size > pack_size - entry->offset) return false;
+    if (entry->format == PACK_FORMAT_PNG) return true;
+    if (entry->format != PACK_FORMAT_ARGB) return false;
+    // Raw pixels are read straight into a buffer of exactly this size.
+    return entry->width && entry->height
+        && entry->size == (uint32_t) entry->width * entry->height * sizeof(uint32_t);
+}
+
+// Decodes a resource from the pack, reading no more than the entry's size.
+static bool resource_decode_packed(rsrc_t *rsrc, FILE *fd) {
+    if (fseek(fd, rsrc->offset, SEEK_SET)) return false;
+    if (rsrc->format == PACK_FORMAT_PNG) {
+        // Decode from memory, so a broken PNG can't make the decoder read into the next resource.
+        uint8_t *data = malloc(rsrc->size);
+        if (!data) return false;
+        bool success = fread(data, 1, rsrc->size, fd) == rsrc->size
+            && pax_decode_png_buf(rsrc->buf, data, rsrc->size, PAX_BUF_32_8888ARGB, CODEC_FLAG_OPTIMAL);
+        free(data);
+        return success;
+    } else if (rsrc->format == PACK_FORMAT_ARGB) {
+        // Already decoded, read straight into the pixels.
+        pax_buf_init(rsrc->buf, NULL, rsrc->width, rsrc->height, PAX_BUF_32_8888ARGB);
+        if (!rsrc->buf->buf) return false;
+        if (fread(rsrc->buf->buf, 1, rsrc->size, fd) != rsrc->size) {
+            pax_buf_destroy(rsrc->buf);
+            return false;
+        }
+        return true;
+    }
+    return false;
+}
+
+// Loads a resource from the pack, before the renderer can see it.
+static bool resource_load_packed(rsrc_t *rsrc, FILE *fd) {
+    rsrc->buf = mem_alloc(MEM_RESOURCES, sizeof(pax_buf_t));
+    if (!rsrc->buf) return false;
+    if (!resource_decode_packed(rsrc, fd)) {
+        mem_free(rsrc->buf);
+        rsrc->buf = NULL;
+        ESP_LOGW(TAG, "Failed to load '%s' from the pack.", rsrc->filename);
+        return false;
+    }
+    rsrc->loaded    = true;
+    rsrc->long_term = true;
+    mem_track(MEM_RESOURCES, resource_pixel_size(rsrc->buf));
+    ESP_LOGI(TAG, "Loaded '%s' from the pack.", rsrc->filename);
+    return true;
+}
 
 // Find the location of and load a resource.
 static pax_buf_t *resource_load(rsrc_t *rsrc) {
-    if (rsrc->loaded) return rsrc->buf;
+    // Packed resources are all loaded with the pack.
+    if (rsrc->loaded || !rsrc->builtin) return rsrc->buf;
     if (rsrc->start && rsrc->end) {
         // Load from embedded data.
         // Make buffer.
-        rsrc->buf = malloc(sizeof(pax_buf_t));
+        rsrc->buf = mem_alloc(MEM_RESOURCES, sizeof(pax_buf_t));
         if (!rsrc->buf) return NULL;
         // Decode PNG.
         bool success = pax_decode_png_buf(
@@ -72,11 +173,12 @@ static pax_buf_t *resource_load(rsrc_t *rsrc) {
         );
         if (!success) {
             // Decode error.
-            free(rsrc->buf);
+            mem_free(rsrc->buf);
             rsrc->buf = NULL;
         } else {
             // Decode success.
             rsrc->loaded = true;
+            mem_track(MEM_RESOURCES, resource_pixel_size(rsrc->buf));
             ESP_LOGI(TAG, "Loaded '%s'.", rsrc->filename);
         }
     } else {
@@ -92,16 +194,27 @@ static void resource_unload(rsrc_t *rsrc) {
         // Mark unloaded.
         rsrc->loaded = false;
         // Destroy buffer.
+        mem_track(MEM_RESOURCES, -resource_pixel_size(rsrc->buf));
         pax_buf_destroy(rsrc->buf);
         // Free buffer struct.
-        free(rsrc->buf);
+        mem_free(rsrc->buf);
         rsrc->buf = NULL;
         ESP_LOGI(TAG, "Unloaded '%s'.", rsrc->filename);
     }
 }
 
-// Look for an embedded resource.
+// Look for a resource, packed resources replace embedded ones.
 static rsrc_t *resource_find(const char *filename) {
+    // Binary search through the pack.
+    size_t lower = 0, upper = atomic_load(&num_packed);
+    while (lower < upper) {
+        size_t mid = (lower + upper) / 2;
+        int cmp = strcmp(filename, packed[mid].filename);
+        if (!cmp) return &packed[mid];
+        if (cmp < 0) upper = mid;
+        else lower = mid + 1;
+    }
+    
     // Sift through embedded resources.
     for (size_t i = 0; i < num_builtins; i++) {
         if (!strcmp(builtins[i].filename, filename)) {
@@ -113,6 +226,99 @@ static rsrc_t *resource_find(const char *filename) {
     return NULL;
 }
 
+// Reads a resource pack and loads all of its resources, so drawing never waits on the filesystem.
+bool resource_load_pack(const char *path) {
+    // Only one pack at a time is supported.
+    if (packed) return false;
+    FILE *fd = fopen(path, "rb");
+    if (!fd) return false;
+    // The index is read one entry at a time, so buffer it.
+    setvbuf(fd, NULL, _IOFBF, PACK_BUFFER);
+    
+    // Entries are checked against the size, so a broken pack can't make loads overrun.
+    long pack_size = -1;
+    if (!fseek(fd, 0, SEEK_END)) pack_size = ftell(fd);
+    if (pack_size < 0 || fseek(fd, 0, SEEK_SET)) {
+        ESP_LOGE(TAG, "Can't get the size of '%s'.", path);
+        fclose(fd);
+        return false;
+    }
+    
+    pack_header_t header;
+    if (fread(&header, sizeof(header), 1, fd) != 1
+            || header.magic != PACK_MAGIC || header.version != PACK_VERSION) {
+        ESP_LOGE(TAG, "'%s' is not a resource pack.", path);
+        fclose(fd);
+        return false;
+    }
+    if (header.count > (pack_size - sizeof(header)) / sizeof(pack_entry_t)) {
+        ESP_LOGE(TAG, "'%s' is cut off.", path);
+        fclose(fd);
+        return false;
+    }
+    
+    // The index stays resident.
+    rsrc_t *index = mem_alloc(MEM_RESOURCES, header.count * sizeof(rsrc_t));
+    char   *names = mem_alloc(MEM_RESOURCES, header.count * PACK_NAME_LEN);
+    if (header.count && (!index || !names)) {
+        ESP_LOGE(TAG, "Out of memory for the index of '%s'.", path);
+        goto error;
+    }
+    for (size_t i = 0; i < header.count; i++) {
+        pack_entry_t entry;
+        if (fread(&entry, sizeof(entry), 1, fd) != 1) {
+            ESP_LOGE(TAG, "'%s' is cut off.", path);
+            goto error;
+        }
+        entry.name[PACK_NAME_LEN - 1] = 0;
+        if (!resource_entry_valid(&entry, pack_size)) {
+            ESP_LOGE(TAG, "Invalid entry '%s' in '%s'.", entry.name, path);
+            goto error;
+        }
+        char *name = names + i * PACK_NAME_LEN;
+        strcpy(name, entry.name);
+        // Lookups are a binary search.
+        if (i && strcmp(index[i-1].filename, name) >= 0) {
+            ESP_LOGE(TAG, "The index of '%s' isn't sorted.", path);
+            goto error;
+        }
+        index[i] = (rsrc_t) {
+            .filename = name,
+            .builtin  = false,
+            .offset   = entry.offset,
+            .size     = entry.size,
+            .format   = entry.format,
+            .width    = entry.width,
+            .height   = entry.height,
+        };
+    }
+    
+    // Runs on the boot task, resources that fail to load are left out and the embedded ones stay in use.
+    size_t count = 0;
+    for (size_t i = 0; i < header.count; i++) {
+        if (resource_load_packed(&index[i], fd)) index[count ++] = index[i];
+    }
+    fclose(fd);
+    
+    packed = index;
+    // Publish only when complete, the renderer may be looking up resources.
+    atomic_store(&num_packed, count);
+    ESP_LOGI(TAG, "Using %u of %u resources from '%s'.", (unsigned) count, (unsigned) header.count, path);
+    return true;
+    
+    error:
+    mem_free(index);
+    mem_free(names);
+    fclose(fd);
+    return false;
+}
+
+// Gets the name of a resource as stored in the resource table, NULL if it doesn't exist.
+const char *resource_name(const char *filename) {
+    rsrc_t *rsrc = resource_find(filename);
+    return rsrc ? rsrc->filename : NULL;
+}
+
 // Get a resource that needs to be available for a long time.
 pax_buf_t *resource_get_long(const char *filename) {
     rsrc_t *rsrc = resource_find(filename);
@@ -0,0 +1,217 @@
+
+#include "save.h"
+#include "artwork.h"
+#include "nvs.h"
+
+static const char *TAG = "save";
+
+typedef struct save_header save_header_t;
+typedef struct save_pole save_pole_t;
+typedef struct save_particle save_particle_t;
+
+struct save_header {
+    // Always SAVE_MAGIC.
+    uint32_t magic;
+    // Always SAVE_VERSION.
+    uint16_t version;
+    // Total size of the save, including this header.
+    uint16_t size;
+    // State of the game's random number generator.
+    uint32_t rng;
+    // Number of poles that follow the bard.
+    uint8_t  num_poles;
+    // Number of particles that follow the poles.
+    uint8_t  num_particles;
+};
+
+struct save_pole {
+    // The pole's position in the level.
+    float   x, y;
+    // The pole's gap size.
+    float   gap;
+    // The visual variation of the pole.
+    uint8_t variant;
+    // Whether the pole has been added to the score yet.
+    bool    counted;
+    // Whether the pole has entered from the right of the screen.
+    bool    onscreen;
+};
+
+struct save_particle {
+    // Position, velocity and gravity.
+    float     x, y, vx, vy, gx, gy;
+    // Air resistance.
+    float     drag;
+    // The color tint.
+    pax_col_t color;
+    // The time that the particle lives for and its current age.
+    uint16_t  lifespan, age;
+    // The filename of the particle's image.
+    char      filename[16];
+};
+
+// Largest possible save.
+#define SAVE_MAX (sizeof(save_header_t) + sizeof(bard_t)\
+    + MAX_FRAME_POLES * sizeof(save_pole_t)\
+    + MAX_FRAME_PARTICLES * sizeof(save_particle_t))
+
+// Save data is built here and written in a single blob.
+static uint8_t    save_buf[SAVE_MAX];
+// Scratch space for copying out the particles.
+static particle_t save_parts[MAX_FRAME_PARTICLES];
+
+// Whether there is a suspended game to resume.
+bool save_exists() {
+    size_t size = 0;
+    return game_nvs && !nvs_get_blob(game_nvs, SAVE_KEY, NULL, &size) && size;
+}
+
+// Writes the game state to flash in one go.
+bool save_store(const bard_t *bard, const pole_t *poles, uint32_t rng) {
+    if (!game_nvs) return false;
+    
+    save_header_t *header = (save_header_t *) save_buf;
+    uint8_t       *pos    = save_buf + sizeof(save_header_t);
+    *header = (save_header_t) {
+        .magic   = SAVE_MAGIC,
+        .version = SAVE_VERSION,
+        .rng     = rng,
+    };
+    
+    // The bard.
+    memcpy(pos, bard, sizeof(bard_t));
+    pos += sizeof(bard_t);
+    
+    // The poles.
+    for (const pole_t *cur = poles; cur && header->num_poles < MAX_FRAME_POLES; cur = cur->next) {
+        if (cur->offscreen) continue;
+        save_pole_t rec = {
+            .x        = cur->x,
+            .y        = cur->y,
+            .gap      = cur->gap,
+            .variant  = cur->variant,
+            .counted  = cur->counted,
+            .onscreen = cur->onscreen,
+        };
+        memcpy(pos, &rec, sizeof(rec));
+        pos += sizeof(rec);
+        header->num_poles ++;
+    }
+    
+    // The particles.
+    size_t num_parts = particle_snapshot(save_parts, MAX_FRAME_PARTICLES);
+    for (size_t i = 0; i < num_parts; i++) {
+        save_particle_t rec = {
+            .x        = save_parts[i].x,
+            .y        = save_parts[i].y,
+            .vx       = save_parts[i].vx,
+            .vy       = save_parts[i].vy,
+            .gx       = save_parts[i].gx,
+            .gy       = save_parts[i].gy,
+            .drag     = save_parts[i].drag,
+            .color    = save_parts[i].color,
+            .lifespan = save_parts[i].lifespan,
+            .age      = save_parts[i].age,
+        };
+        strncpy(rec.filename, save_parts[i].filename, sizeof(rec.filename) - 1);
+        memcpy(pos, &rec, sizeof(rec));
+        pos += sizeof(rec);
+    }
+    header->num_particles = num_parts;
+    header->size          = pos - save_buf;
+    
+    // One blob, one commit.
+    esp_err_t res = nvs_set_blob(game_nvs, SAVE_KEY, save_buf, header->size);
+    if (!res) res = nvs_commit(game_nvs);
+    if (res) {
+        ESP_LOGE(TAG, "Failed to save game: %s", esp_err_to_name(res));
+        return false;
+    }
+    ESP_LOGI(TAG, "Saved game (%u bytes).", header->size);
+    return true;
+}
+
+// Reads and removes the suspended game, returns its poles or NULL if there is none.
+pole_t *save_load(bard_t *bard, uint32_t *rng) {
+    if (!game_nvs) return NULL;
+    
+    // Read the blob.
+    size_t    size = sizeof(save_buf);
+    esp_err_t res  = nvs_get_blob(game_nvs, SAVE_KEY, save_buf, &size);
+    if (res) return NULL;
+    // A save is only good for one resume.
+    nvs_erase_key(game_nvs, SAVE_KEY);
+    nvs_commit(game_nvs);
+    
+    // Check it matches this version of the game.
+    save_header_t *header = (save_header_t *) save_buf;
+    size_t expected = sizeof(save_header_t) + sizeof(bard_t)
+        + header->num_poles * sizeof(save_pole_t)
+        + header->num_particles * sizeof(save_particle_t);
+    if (size < sizeof(save_header_t) || header->magic != SAVE_MAGIC
+            || header->version != SAVE_VERSION || header->size != size
+            || size != expected || !header->num_poles) {
+        ESP_LOGW(TAG, "Discarding incompatible save.");
+        return NULL;
+    }
+    const uint8_t *pos = save_buf + sizeof(save_header_t);
+    
+    // The bard.
+    memcpy(bard, pos, sizeof(bard_t));
+    pos += sizeof(bard_t);
+    *rng = header->rng;
+    
+    // The poles.
+    pole_t *first = NULL, *last = NULL;
+    for (size_t i = 0; i < header->num_poles; i++) {
+        save_pole_t rec;
+        memcpy(&rec, pos, sizeof(rec));
+        pos += sizeof(rec);
+        
+        pole_t *pole = mem_alloc(MEM_POLES, sizeof(pole_t));
+        if (!pole) break;
+        *pole = (pole_t) {
+            .prev      = last,
+            .next      = NULL,
+            .x         = rec.x,
+            .y         = rec.y,
+            .gap       = rec.gap,
+            .variant   = rec.variant,
+            .counted   = rec.counted,
+            .offscreen = false,
+            .onscreen  = rec.onscreen,
+        };
+        if (last) last->next = pole;
+        else first = pole;
+        last = pole;
+    }
+    
+    // The particles, only those whose image still exists.
+    for (size_t i = 0; i < header->num_particles; i++) {
+        save_particle_t rec;
+        memcpy(&rec, pos, sizeof(rec));
+        pos += sizeof(rec);
+        
+        rec.filename[sizeof(rec.filename) - 1] = 0;
+        const char *filename = resource_name(rec.filename);
+        if (!filename) continue;
+        particle_add((particle_t) {
+            .x        = rec.x,
+            .y        = rec.y,
+            .vx       = rec.vx,
+            .vy       = rec.vy,
+            .gx       = rec.gx,
+            .gy       = rec.gy,
+            .drag     = rec.drag,
+            .filename = filename,
+            .color    = rec.color,
+            .lifespan = rec.lifespan,
+            .age      = rec.age,
+        });
+    }
+    
+    // Give the player a moment before continuing.
+    bard->paused = true;
+    ESP_LOGI(TAG, "Resumed game at score %llu.", bard->score);
+    return first;
+}
@@ -0,0 +1,38 @@
+
+#include "storage.h"
+#include "esp_vfs_fat.h"
+#include "stdatomic.h"
+#include "sys/stat.h"
+
+static const char *TAG = "storage";
+
+// Whether the FAT partition is mounted, it is mounted by the boot task.
+static _Atomic bool mounted;
+
+// Mounts the FAT partition, never formats it.
+bool storage_mount() {
+    if (atomic_load(&mounted)) return true;
+    
+    // The partition is shared with other apps on the badge, a failed mount must not wipe it.
+    static const esp_vfs_fat_mount_config_t config = {
+        .format_if_mount_failed = false,
+        .max_files              = STORAGE_MAX_FILES,
+        .allocation_unit_size   = CONFIG_WL_SECTOR_SIZE,
+    };
+    static wl_handle_t handle;
+    esp_err_t res = esp_vfs_fat_spiflash_mount(STORAGE_PATH, STORAGE_LABEL, &config, &handle);
+    if (res) {
+        ESP_LOGE(TAG, "Failed to mount %s: %s, continuing without files.", STORAGE_LABEL, esp_err_to_name(res));
+        return false;
+    }
+    
+    // It's fine if the directory already exists.
+    mkdir(STORAGE_DIR, 0777);
+    atomic_store(&mounted, true);
+    return true;
+}
+
+// Whether the FAT partition is mounted.
+bool storage_ready() {
+    return atomic_load(&mounted);
+}
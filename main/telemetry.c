@@ -0,0 +1,204 @@
+
+#include "telemetry.h"
+#include "quality.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "stdio.h"
+#include "sys/stat.h"
+
+static const char *TAG = "telemetry";
+
+typedef struct {
+    // TELEMETRY_REQ_START or TELEMETRY_REQ_END.
+    int      type;
+    // Value of ring_head when the session ended.
+    uint32_t head;
+} telemetry_req_t;
+
+// Records waiting to be written, filled by the renderer and drained by the writer task.
+static telemetry_record_t ring[TELEMETRY_RING];
+// Number of records ever added.
+static _Atomic uint32_t   ring_head;
+// Number of records ever written.
+static _Atomic uint32_t   ring_tail;
+// Number of records dropped this session.
+static _Atomic uint32_t   dropped;
+// Session starts and ends for the writer task, in order.
+static QueueHandle_t      req_queue;
+// Number of the next frame in the session.
+static uint32_t           frame_no;
+// Whether a session is running.
+static bool               running;
+// Whether an ended session may still be being written.
+static bool               closing;
+// The writer task.
+static TaskHandle_t       writer_handle;
+// Given by the writer task once an ended session is closed.
+static SemaphoreHandle_t  closed;
+
+// Writes a session's header at the current position.
+static bool telemetry_header(FILE *fd, uint32_t num_dropped) {
+    telemetry_header_t header = {
+        .magic       = TELEMETRY_MAGIC,
+        .version     = TELEMETRY_VERSION,
+        .record_size = sizeof(telemetry_record_t),
+        .target_us   = FRAME_TARGET_US,
+        .dropped     = num_dropped,
+    };
+    return fwrite(&header, sizeof(header), 1, fd) == 1;
+}
+
+// Opens the file for a new session and writes its header, remembering where the header is.
+static FILE *telemetry_open(long *header_pos) {
+    // Start over when the file has grown too large or holds an older version.
+    FILE *fd = fopen(TELEMETRY_PATH, "r+b");
+    if (fd) {
+        telemetry_header_t first;
+        bool same = fread(&first, sizeof(first), 1, fd) == 1 && first.magic == TELEMETRY_MAGIC
+            && first.version == TELEMETRY_VERSION && first.record_size == sizeof(telemetry_record_t);
+        if (!same || fseek(fd, 0, SEEK_END) || ftell(fd) >= TELEMETRY_MAX_SIZE) {
+            fclose(fd);
+            fd = NULL;
+        }
+    }
+    if (!fd) fd = fopen(TELEMETRY_PATH, "wb");
+    if (!fd) {
+        ESP_LOGW(TAG, "Can't open %s.", TELEMETRY_PATH);
+        return NULL;
+    }
+    
+    // Appending mode would keep the header from being rewritten, so seek to the end instead.
+    *header_pos = ftell(fd);
+    if (*header_pos < 0 || !telemetry_header(fd, 0)) {
+        ESP_LOGW(TAG, "Can't write to %s.", TELEMETRY_PATH);
+        fclose(fd);
+        return NULL;
+    }
+    return fd;
+}
+
+// Closes a session, rewriting its header with the number of records it dropped.
+static void telemetry_close(FILE *fd, long header_pos, uint32_t num_dropped) {
+    if (num_dropped && (fseek(fd, header_pos, SEEK_SET) || !telemetry_header(fd, num_dropped))) {
+        ESP_LOGW(TAG, "Can't record the dropped count.");
+    }
+    fclose(fd);
+}
+
+// Writes up to max records from the ring, in at most two contiguous writes.
+static void telemetry_write(FILE *fd, uint32_t max) {
+    uint32_t tail  = atomic_load_explicit(&ring_tail, memory_order_relaxed);
+    uint32_t count = atomic_load_explicit(&ring_head, memory_order_acquire) - tail;
+    if (count > max) count = max;
+    while (count) {
+        uint32_t index = tail % TELEMETRY_RING;
+        uint32_t chunk = TELEMETRY_RING - index < count ? TELEMETRY_RING - index : count;
+        if (fd) fwrite(&ring[index], sizeof(telemetry_record_t), chunk, fd);
+        tail  += chunk;
+        count -= chunk;
+        atomic_store_explicit(&ring_tail, tail, memory_order_release);
+    }
+}
+
+// Writes batches of records to FAT, away from the game.
+static void telemetry_task(void *args) {
+    FILE *fd         = NULL;
+    long  header_pos = 0;
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        
+        // In the order they were made, a whole session may have passed since the last wakeup.
+        telemetry_req_t req;
+        while (xQueueReceive(req_queue, &req, 0)) {
+            if (req.type == TELEMETRY_REQ_START) {
+                if (!fd && storage_ready()) fd = telemetry_open(&header_pos);
+                continue;
+            }
+            telemetry_write(fd, req.head - atomic_load(&ring_tail));
+            uint32_t num_dropped = atomic_exchange(&dropped, 0);
+            if (num_dropped) ESP_LOGW(TAG, "Dropped %u records.", num_dropped);
+            if (fd) telemetry_close(fd, header_pos, num_dropped);
+            fd = NULL;
+            xSemaphoreGive(closed);
+        }
+        // Full batches only, so FAT sees few large writes.
+        while (atomic_load(&ring_head) - atomic_load(&ring_tail) >= TELEMETRY_BATCH) {
+            telemetry_write(fd, TELEMETRY_BATCH);
+        }
+    }
+}
+
+// Starts the writer task.
+bool telemetry_init() {
+    closed    = xSemaphoreCreateBinary();
+    req_queue = xQueueCreate(TELEMETRY_REQ_QUEUE, sizeof(telemetry_req_t));
+    if (!closed || !req_queue) return false;
+    // Lowest priority that still beats idle, writes are never urgent.
+    return xTaskCreatePinnedToCore(
+        telemetry_task, "telemetry", TELEMETRY_STACK, NULL,
+        tskIDLE_PRIORITY + 1, &writer_handle, TELEMETRY_CORE
+    ) == pdPASS;
+}
+
+// Starts a new session.
+void telemetry_start() {
+    if (!writer_handle) return;
+    telemetry_req_t req = { .type = TELEMETRY_REQ_START };
+    frame_no = 0;
+    running  = xQueueSend(req_queue, &req, 0) == pdTRUE;
+    xTaskNotifyGive(writer_handle);
+}
+
+// Records a frame, never blocks or allocates. Only the renderer may call this.
+void telemetry_frame(const frame_t *frame, int64_t frame_us) {
+    if (!running) return;
+    uint32_t head = atomic_load_explicit(&ring_head, memory_order_relaxed);
+    if (head - atomic_load_explicit(&ring_tail, memory_order_acquire) >= TELEMETRY_RING) {
+        // The writer fell behind, keep the game going.
+        atomic_fetch_add(&dropped, 1);
+        frame_no ++;
+        return;
+    }
+    
+    const bard_t *bard = &frame->bard;
+    ring[head % TELEMETRY_RING] = (telemetry_record_t) {
+        .frame         = frame_no ++,
+        .frame_us      = frame_us,
+        .y             = bard->y,
+        .vel           = bard->vel,
+        .score         = bard->score,
+        .pole_dist     = bard->pole_dist,
+        .pole_gap      = bard->pole_gap,
+        .num_poles     = frame->num_poles,
+        .num_particles = frame->num_particles,
+        .quality       = quality_tier(),
+        .flags         = (bard->alive ? TELEMETRY_ALIVE : 0) | (bard->paused ? TELEMETRY_PAUSED : 0),
+    };
+    atomic_store_explicit(&ring_head, head + 1, memory_order_release);
+    
+    // Only wake the writer once there is a batch.
+    if ((head + 1) % TELEMETRY_BATCH == 0) xTaskNotifyGive(writer_handle);
+}
+
+// Ends the session, writing out what's left.
+void telemetry_end() {
+    if (!running) return;
+    running = false;
+    // Forget sessions closed before, so a wait is for this one.
+    xSemaphoreTake(closed, 0);
+    telemetry_req_t req = {
+        .type = TELEMETRY_REQ_END,
+        .head = atomic_load(&ring_head),
+    };
+    closing = xQueueSend(req_queue, &req, 0) == pdTRUE;
+    if (!closing) ESP_LOGW(TAG, "Too many requests, the session isn't closed.");
+    xTaskNotifyGive(writer_handle);
+}
+
+// Waits for the writer task to close the ended session, returns false on timeout.
+bool telemetry_wait(uint32_t timeout_ms) {
+    if (!closing) return true;
+    closing = false;
+    return xSemaphoreTake(closed, pdMS_TO_TICKS(timeout_ms)) == pdTRUE;
+}
@@ -0,0 +1,132 @@
+
+// Host benchmark of the sound effect mixer, renders a minute of gameplay sounds to a WAV.
+
+#include "mixer.h"
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+#include "time.h"
+
+// Same as AUDIO_RATE.
+#define BENCH_RATE    16000
+// Length of the benchmark in seconds of audio.
+#define BENCH_SECONDS 60
+// Largest share of real time that mixing may take on the host, in percent.
+#define BENCH_BUDGET  10
+
+typedef struct {
+    // File name in main/resources.
+    const char *name;
+    // Seconds between triggers.
+    float       every;
+    // The samples.
+    int16_t    *data;
+    size_t      len;
+} sound_t;
+
+static sound_t sounds[] = {
+    { .name = "jump.pcm",  .every = 0.4f },
+    { .name = "score.pcm", .every = 1.5f },
+    { .name = "death.pcm", .every = 10   },
+};
+static const size_t num_sounds = sizeof(sounds) / sizeof(sound_t);
+
+// Reads a whole file, exits on failure.
+static void *read_file(const char *dir, const char *name, size_t *len) {
+    char path[512];
+    snprintf(path, sizeof(path), "%s/%s", dir, name);
+    FILE *fd = fopen(path, "rb");
+    if (!fd) {
+        fprintf(stderr, "Can't open %s\n", path);
+        exit(1);
+    }
+    fseek(fd, 0, SEEK_END);
+    *len = ftell(fd);
+    fseek(fd, 0, SEEK_SET);
+    void *data = malloc(*len);
+    if (fread(data, 1, *len, fd) != *len) exit(1);
+    fclose(fd);
+    return data;
+}
+
+// Writes a little endian integer of a number of bytes.
+static void write_le(FILE *fd, uint32_t value, int bytes) {
+    for (int i = 0; i < bytes; i++) fputc(value >> (i * 8), fd);
+}
+
+static double now_us() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+int main(int argc, char **argv) {
+    if (argc != 3) {
+        fprintf(stderr, "Usage: %s <resources dir> <output.wav>\n", argv[0]);
+        return 1;
+    }
+    for (size_t i = 0; i < num_sounds; i++) {
+        size_t len;
+        sounds[i].data = read_file(argv[1], sounds[i].name, &len);
+        sounds[i].len  = len / sizeof(int16_t);
+    }
+    
+    size_t   blocks  = BENCH_RATE * BENCH_SECONDS / MIXER_BLOCK;
+    size_t   samples = blocks * MIXER_BLOCK;
+    int16_t *out     = malloc(samples * 2 * sizeof(int16_t));
+    double   busy    = 0;
+    size_t   peak    = 0;
+    
+    for (size_t block = 0; block < blocks; block++) {
+        double start = now_us();
+        // Trigger sounds like the game does, at most once per block.
+        for (size_t i = 0; i < num_sounds; i++) {
+            size_t every = sounds[i].every * BENCH_RATE / MIXER_BLOCK;
+            if (block % every == 0) mixer_start(sounds[i].data, sounds[i].data + sounds[i].len);
+        }
+        mixer_mix(out + block * MIXER_BLOCK * 2);
+        busy += now_us() - start;
+    }
+    for (size_t i = 0; i < samples * 2; i++) {
+        size_t level = abs(out[i]);
+        if (level > peak) peak = level;
+    }
+    
+    // 16-bit stereo WAV.
+    FILE *fd = fopen(argv[2], "wb");
+    if (!fd) {
+        fprintf(stderr, "Can't write %s\n", argv[2]);
+        return 1;
+    }
+    uint32_t data_size = samples * 2 * sizeof(int16_t);
+    fwrite("RIFF", 1, 4, fd);
+    write_le(fd, 36 + data_size, 4);
+    fwrite("WAVEfmt ", 1, 8, fd);
+    write_le(fd, 16, 4);
+    write_le(fd, 1, 2);
+    write_le(fd, 2, 2);
+    write_le(fd, BENCH_RATE, 4);
+    write_le(fd, BENCH_RATE * 4, 4);
+    write_le(fd, 4, 2);
+    write_le(fd, 16, 2);
+    fwrite("data", 1, 4, fd);
+    write_le(fd, data_size, 4);
+    fwrite(out, 1, data_size, fd);
+    fclose(fd);
+    
+    double real  = BENCH_SECONDS * 1e6;
+    double share = busy * 100 / real;
+    printf("Mixed %zu blocks of %d samples, %.2f us per block, %.3f%% of real time.\n",
+        blocks, MIXER_BLOCK, busy / blocks, share);
+    printf("Peak level %zu, wrote %s.\n", peak, argv[2]);
+    
+    if (!peak) {
+        fprintf(stderr, "Nothing was mixed.\n");
+        return 1;
+    }
+    if (share > BENCH_BUDGET) {
+        fprintf(stderr, "Mixing took more than %d%% of real time.\n", BENCH_BUDGET);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,61 @@
+
+// Host benchmark of the bard's collision masks against the axis-aligned box they replaced.
+
+#include "collision.h"
+#include "time.h"
+
+// Number of tests to time of each kind.
+#define BENCH_CALLS  1000000
+// Largest slowdown of the mask test over the box test before the benchmark fails.
+#define BENCH_FACTOR 20
+
+static double now_us() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+int main() {
+    collision_init();
+    bard_t bard = { .x = 50, .level_pos = 0 };
+    pole_t pole = { .y = 150, .gap = 60 };
+    volatile int hits_mask = 0, hits_box = 0;
+    
+    // Sweep the bard through the gap and past the edge at every angle.
+    double start = now_us();
+    for (int i = 0; i < BENCH_CALLS; i++) {
+        bard.y     = 60 + i % 100;
+        bard.angle = i * 0.01f;
+        pole.x     = 20 + i % 50;
+        hits_mask += collision_pole(&bard, &pole) != 0;
+    }
+    double mask_time = now_us() - start;
+    
+    // The axis-aligned box with leniency that the masks replaced.
+    start = now_us();
+    for (int i = 0; i < BENCH_CALLS; i++) {
+        bard.y     = 60 + i % 100;
+        bard.angle = i * 0.01f;
+        pole.x     = 20 + i % 50;
+        float x    = pole.x - bard.level_pos - bard.x;
+        if (x > HITBOX_RADIUS - POLE_LENIENCE || x < POLE_LENIENCE - POLE_WIDTH - HITBOX_RADIUS) continue;
+        hits_box  += bard.y <= pole.y - pole.gap + HITBOX_RADIUS - POLE_LENIENCE
+                  || bard.y >= pole.y - HITBOX_RADIUS + POLE_LENIENCE;
+    }
+    double box_time = now_us() - start;
+    
+    printf("Mask test %.2f ns, box test %.2f ns per call (%d and %d hits in %d).\n",
+        mask_time * 1000 / BENCH_CALLS, box_time * 1000 / BENCH_CALLS,
+        hits_mask, hits_box, BENCH_CALLS
+    );
+    
+    if (!hits_mask || !hits_box) {
+        fprintf(stderr, "The sweep never hit the pole.\n");
+        return 1;
+    }
+    if (mask_time > box_time * BENCH_FACTOR) {
+        fprintf(stderr, "The mask test is more than %d times slower than the box.\n", BENCH_FACTOR);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,46 @@
+
+// Host test of the bard's collision masks.
+
+#include "collision.h"
+#include "quality.h"
+#include "check.h"
+
+bool debug_state;
+const pax_font_t *font_big;
+const pax_font_t *font_small;
+nvs_handle_t game_nvs;
+xQueueHandle buttonQueue;
+particle_t *particles;
+
+int main() {
+    collision_init();
+    
+    // A pole whose body covers every row of the bard.
+    pole_t pole = { .x = 200, .y = 20, .gap = 10 };
+    bard_t bard = { .y = 120, .level_pos = 37.5f };
+    
+    // At every angle, pushing the bard out by collision_right clears the pole's edge.
+    for (int i = 0; i < 720; i++) {
+        bard.angle = i * M_PI_F / 360;
+        bard.x     = floorf(pole.x - bard.level_pos) - collision_right(&bard);
+        CHECK(!collision_pole(&bard, &pole), "angle %.3f: still hits after the push", bard.angle);
+        // One pixel closer does hit, so the push isn't larger than needed.
+        bard.x += 1;
+        CHECK(collision_pole(&bard, &pole), "angle %.3f: push is wider than the mask", bard.angle);
+        CHECK(collision_right(&bard) <= COLL_RADIUS, "angle %.3f: mask wider than its buffer", bard.angle);
+    }
+    
+    // Unrotated, the mask is the hitbox.
+    bard.angle = 0;
+    CHECK(collision_right(&bard) == HITBOX_RADIUS, "unrotated extent %d", collision_right(&bard));
+    
+    // Drawing the bard flat at lower quality doesn't change how it collides.
+    bard.angle = M_PI_F / 4;
+    int rotated = collision_right(&bard);
+    CHECK(rotated > HITBOX_RADIUS, "rotated extent %d", rotated);
+    while (quality()->rotate_bard) quality_frame(FRAME_TARGET_US * 2);
+    CHECK(collision_right(&bard) == rotated, "flat tier extent %d, expected %d", collision_right(&bard), rotated);
+    quality_reset();
+    
+    return check_report("Collision");
+}
@@ -0,0 +1,121 @@
+
+// Host test of ghost recording through the writer task, and playback of the best run.
+
+#include "ghost.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "sys/stat.h"
+#include "check.h"
+
+// The test's directory is always there.
+bool storage_ready() {
+    return true;
+}
+
+// Number of steps in a paced run.
+#define RUN_STEPS 600
+
+// Position of the bard in a run at a step, with a jump that needs an absolute sample.
+static void run_pos(int run, int step, bard_t *bard) {
+    bard->y     = 100 + 40 * sinf(step / 20.0f + run) + (step == 300 ? 90 : 0);
+    bard->angle = 0.5f * cosf(step / 15.0f + run);
+}
+
+// Whether a file exists.
+static bool exists(const char *path) {
+    struct stat info;
+    return !stat(path, &info);
+}
+
+// Waits for the writer task to close the recording.
+static void wait_writer() {
+    for (int i = 0; i < 200 && exists(GHOST_TEMP); i++) vTaskDelay(10);
+    vTaskDelay(GHOST_WRITE_MS + 50);
+}
+
+// Records a run at roughly the game's pace.
+static void record_run(int run, bool best) {
+    ghost_start();
+    bard_t bard = {0};
+    for (int i = 0; i < RUN_STEPS; i++) {
+        run_pos(run, i, &bard);
+        ghost_record(&bard);
+        float y, angle;
+        ghost_next(&y, &angle);
+        vTaskDelay(1);
+    }
+    ghost_finish(best);
+    wait_writer();
+}
+
+// Steps the last matching playback took to start.
+static int playback_delay;
+
+// Plays back the best run at roughly the game's pace, returns the run it matches or -1.
+static int playback_run() {
+    int    match = -1;
+    bard_t bard  = {0};
+    for (int run = 0; run < 4 && match < 0; run++) {
+        ghost_finish(false);
+        ghost_start();
+        // The ghost may start late while the writer task reads ahead, but then stays in step.
+        int shown = -1;
+        for (int i = 0; i < RUN_STEPS; i++) {
+            float y, angle;
+            run_pos(run, i, &bard);
+            bool got = ghost_next(&y, &angle);
+            if (got && shown < 0) shown = i;
+            if (shown >= 0 && (!got
+                    || fabsf(y - bard.y) > 0.5f / GHOST_Y_SCALE
+                    || fabsf(angle - bard.angle) > 0.5f / GHOST_ANGLE_SCALE)) {
+                shown = -1;
+                break;
+            }
+            vTaskDelay(1);
+        }
+        if (shown >= 0) {
+            match          = run;
+            playback_delay = shown;
+        }
+    }
+    ghost_finish(false);
+    wait_writer();
+    return match;
+}
+
+int main() {
+    mkdir(STORAGE_PATH, 0777);
+    mkdir(STORAGE_DIR, 0777);
+    remove(GHOST_PATH);
+    CHECK(ghost_init(), "writer task didn't start");
+    
+    // A best run is kept and plays back sample for sample.
+    record_run(1, true);
+    CHECK(exists(GHOST_PATH) && !exists(GHOST_TEMP), "best run not kept");
+    CHECK(playback_run() == 1, "best run doesn't play back");
+    CHECK(playback_delay < 50, "playback took %d steps to start", playback_delay);
+    
+    // A run that isn't the best is thrown away.
+    record_run(2, false);
+    CHECK(!exists(GHOST_TEMP), "temporary trace left behind");
+    CHECK(playback_run() == 1, "best run replaced by a worse one");
+    
+    // A run that outpaces the writer is incomplete and never kept, even as the best.
+    ghost_start();
+    bard_t bard = {0};
+    int64_t slowest = 0;
+    for (int i = 0; i < GHOST_RING; i++) {
+        bard.y     = i % 2 ? 200 : 10;
+        bard.angle = i % 2 ? 1 : -1;
+        int64_t start = esp_timer_get_time();
+        ghost_record(&bard);
+        int64_t time = esp_timer_get_time() - start;
+        if (time > slowest) slowest = time;
+    }
+    ghost_finish(true);
+    wait_writer();
+    CHECK(playback_run() == 1, "incomplete run was kept");
+    printf("Slowest ghost_record: %lld us.\n", (long long) slowest);
+    
+    return check_report("Ghost");
+}
@@ -0,0 +1,45 @@
+
+// Host test of the render check's band hashes and golden comparison.
+
+#include "golden.h"
+#include "check.h"
+
+static uint16_t pixels[SCREEN_WIDTH * SCREEN_HEIGHT];
+static uint16_t noisy[SCREEN_WIDTH * SCREEN_HEIGHT];
+
+int main() {
+    // The reference image, a gradient through every channel.
+    for (int i = 0; i < SCREEN_WIDTH * SCREEN_HEIGHT; i++) pixels[i] = i * 2654435761u >> 16;
+    uint32_t golden[RENDER_CHECK_BANDS];
+    golden_hash(pixels, golden);
+    
+    // The mask keeps the three high bits of red and blue and the four high bits of green.
+    CHECK(RENDER_CHECK_MASK == ((0x07 << 13) | (0x0f << 7) | (0x07 << 2)), "mask 0x%04x", RENDER_CHECK_MASK);
+    
+    // Noise in the two low bits of any channel is ignored.
+    for (int i = 0; i < SCREEN_WIDTH * SCREEN_HEIGHT; i++) {
+        uint16_t noise = (i * 7) & 3;
+        noisy[i] = pixels[i] ^ (noise << 11) ^ (noise << 5) ^ noise;
+    }
+    uint32_t hashes[RENDER_CHECK_BANDS];
+    golden_hash(noisy, hashes);
+    int differ;
+    CHECK(golden_compare(golden, hashes, &differ) == GOLDEN_OK, "low bit noise differs in %d bands", differ);
+    
+    // A change in a high bit of one channel fails exactly the band it is in.
+    static const uint16_t high_bits[] = { 1 << 13, 1 << 7, 1 << 2 };
+    for (size_t i = 0; i < sizeof(high_bits) / sizeof(uint16_t); i++) {
+        memcpy(noisy, pixels, sizeof(pixels));
+        noisy[(5 * BAND_HEIGHT + 3) * SCREEN_WIDTH + 17] ^= high_bits[i];
+        golden_hash(noisy, hashes);
+        CHECK(golden_compare(golden, hashes, &differ) == GOLDEN_FAIL, "bit 0x%04x not caught", high_bits[i]);
+        CHECK(differ == 1, "bit 0x%04x changed %d bands", high_bits[i], differ);
+        CHECK(hashes[5] != golden[5], "bit 0x%04x changed the wrong band", high_bits[i]);
+    }
+    
+    // An empty table is unrecorded, never a pass.
+    uint32_t empty[RENDER_CHECK_BANDS] = {0};
+    CHECK(golden_compare(empty, golden, NULL) == GOLDEN_UNRECORDED, "empty table not reported as unrecorded");
+    
+    return check_report("Golden hash");
+}
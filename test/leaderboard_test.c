@@ -0,0 +1,304 @@
+
+// Host test of leaderboard syncing against a stub HTTP server: idling, retries, timeouts and oversized responses.
+
+#define _GNU_SOURCE
+
+#include "leaderboard.h"
+#include "esp_http_client.h"
+#include "freertos/task.h"
+#include "check.h"
+#include <pthread.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+
+// Longest a call from the game may take, a flash commit alone takes HOST_NVS_COMMIT_MS.
+#define MAX_CALL_US 1000
+// Maximum number of requests remembered.
+#define MAX_REQUESTS 64
+
+nvs_handle_t game_nvs = 1;
+
+/* ==== Radio ==== */
+
+// Whether the radio is on.
+static _Atomic bool    radio_on;
+// Number of times the radio was turned on.
+static _Atomic int     radio_connects;
+// When the radio was last turned on and off.
+static _Atomic int64_t radio_on_time, radio_off_time;
+
+void wifi_init() {
+}
+
+void wifi_lazy_init() {
+}
+
+bool wifi_connect_to_stored() {
+    atomic_store(&radio_on_time, esp_timer_get_time());
+    atomic_store(&radio_on, true);
+    atomic_fetch_add(&radio_connects, 1);
+    return true;
+}
+
+void wifi_disconnect_and_disable() {
+    atomic_store(&radio_off_time, esp_timer_get_time());
+    atomic_store(&radio_on, false);
+}
+
+/* ==== Server ==== */
+
+typedef struct {
+    // Whether it was a POST to /runs, otherwise a GET of /top.
+    bool    upload;
+    // When it arrived.
+    int64_t time;
+    // Number of runs in an upload.
+    int     runs;
+} request_t;
+
+static pthread_mutex_t server_lock = PTHREAD_MUTEX_INITIALIZER;
+static request_t       requests[MAX_REQUESTS];
+static int             num_requests;
+// Number of uploads to fail with a 500.
+static int             fail_uploads;
+// Time to wait before answering.
+static int             delay_ms;
+// Body of the top scores.
+static const char     *top_body = "[{\"name\": \"Alice\", \"score\": 120}, {\"name\": \"Bob\", \"score\": 80}]";
+// ETag of the top scores, changed whenever they are.
+static int             top_etag = 1;
+
+// Counts requests of a kind since a time.
+static int count_requests(bool upload, int64_t since) {
+    pthread_mutex_lock(&server_lock);
+    int count = 0;
+    for (int i = 0; i < num_requests; i++) {
+        if (requests[i].upload == upload && requests[i].time >= since) count ++;
+    }
+    pthread_mutex_unlock(&server_lock);
+    return count;
+}
+
+// Answers one request.
+static void serve(int fd) {
+    char req[4096];
+    int  len = 0;
+    char *end = NULL;
+    while (!end && len < (int) sizeof(req) - 1) {
+        int got = recv(fd, req + len, sizeof(req) - 1 - len, 0);
+        if (got <= 0) return;
+        len += got;
+        req[len] = 0;
+        end = strstr(req, "\r\n\r\n");
+    }
+    if (!end) return;
+    char *length = strcasestr(req, "Content-Length:");
+    int body_len = length ? atoi(length + 15) : 0;
+    while (len - (end + 4 - req) < body_len && len < (int) sizeof(req) - 1) {
+        int got = recv(fd, req + len, sizeof(req) - 1 - len, 0);
+        if (got <= 0) return;
+        len += got;
+        req[len] = 0;
+    }
+    
+    pthread_mutex_lock(&server_lock);
+    request_t *cur = num_requests < MAX_REQUESTS ? &requests[num_requests ++] : &requests[MAX_REQUESTS - 1];
+    cur->upload = !strncmp(req, "POST /runs ", 11);
+    cur->time   = esp_timer_get_time();
+    cur->runs   = 0;
+    for (char *pos = end; (pos = strstr(pos, "\"score\"")); pos ++) cur->runs ++;
+    bool fail  = cur->upload && fail_uploads > 0;
+    if (fail) fail_uploads --;
+    int  delay = delay_ms;
+    char etag[16];
+    snprintf(etag, sizeof(etag), "\"%d\"", top_etag);
+    bool same  = strstr(req, etag) && strcasestr(req, "If-None-Match");
+    const char *body = top_body;
+    pthread_mutex_unlock(&server_lock);
+    
+    if (delay) vTaskDelay(delay);
+    char head[256];
+    if (fail) {
+        dprintf(fd, "HTTP/1.1 500 Internal Server Error\r\nContent-Length: 0\r\n\r\n");
+    } else if (cur->upload) {
+        dprintf(fd, "HTTP/1.1 200 OK\r\nContent-Length: 0\r\n\r\n");
+    } else if (same) {
+        dprintf(fd, "HTTP/1.1 304 Not Modified\r\nETag: %s\r\nContent-Length: 0\r\n\r\n", etag);
+    } else {
+        int head_len = snprintf(head, sizeof(head), "HTTP/1.1 200 OK\r\nETag: %s\r\nContent-Length: %zu\r\n\r\n", etag, strlen(body));
+        send(fd, head, head_len, MSG_NOSIGNAL);
+        send(fd, body, strlen(body), MSG_NOSIGNAL);
+    }
+}
+
+// Answers requests one at a time, like a slow little server.
+static void *server_main(void *arg) {
+    int listener = (intptr_t) arg;
+    while (1) {
+        int fd = accept(listener, NULL, NULL);
+        if (fd < 0) continue;
+        serve(fd);
+        close(fd);
+    }
+    return NULL;
+}
+
+// Starts the server on a free port.
+static void server_start() {
+    int listener = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in addr = { .sin_family = AF_INET };
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t addr_len = sizeof(addr);
+    bind(listener, (struct sockaddr *) &addr, sizeof(addr));
+    listen(listener, 8);
+    getsockname(listener, (struct sockaddr *) &addr, &addr_len);
+    host_http_port = ntohs(addr.sin_port);
+    pthread_t thread;
+    pthread_create(&thread, NULL, server_main, (void *) (intptr_t) listener);
+}
+
+/* ==== Helpers ==== */
+
+// Waits until a condition holds, returns false after a timeout.
+#define WAIT_FOR(cond, timeout_ms) ({\
+        int64_t deadline = esp_timer_get_time() + (timeout_ms) * 1000LL;\
+        bool    met;\
+        while (!(met = (cond)) && esp_timer_get_time() < deadline) vTaskDelay(1);\
+        met;\
+    })
+
+// Number of runs waiting to be uploaded, as persisted.
+static int stored_runs() {
+    lb_run_t runs[LB_QUEUE_MAX];
+    size_t size = sizeof(runs);
+    if (nvs_get_blob(game_nvs, LB_QUEUE_KEY, runs, &size)) return 0;
+    return size / sizeof(lb_run_t);
+}
+
+// Submits a run, checking that the game isn't held up.
+static void submit(uint64_t score) {
+    int64_t start = esp_timer_get_time();
+    leaderboard_submit(score);
+    int64_t time = esp_timer_get_time() - start;
+    CHECK(time < MAX_CALL_US, "leaderboard_submit took %lld us", (long long) time);
+}
+
+// Leaves the menu and waits for a sync that was running to stop.
+static void start_playing() {
+    leaderboard_idle(false);
+    WAIT_FOR(!atomic_load(&radio_on), LB_TIMEOUT_MS * 4);
+    vTaskDelay(LB_POLL_MS * 2);
+}
+
+int main() {
+    server_start();
+    CHECK(leaderboard_init(), "leaderboard didn't start");
+    // The cache starts out empty.
+    lb_top_t top = {0};
+    CHECK(leaderboard_top(&top) && top.count == 0, "cached top scores not empty");
+    
+    // While playing, a run is persisted by the sync task but the radio stays off.
+    submit(42);
+    CHECK(WAIT_FOR(stored_runs() == 1, 500), "run not persisted");
+    vTaskDelay(LB_IDLE_MS * 3);
+    CHECK(atomic_load(&radio_connects) == 0, "radio turned on during a game");
+    
+    // Idling in the menu uploads it, then fetches the top scores.
+    int64_t idle = esp_timer_get_time();
+    leaderboard_idle(true);
+    CHECK(WAIT_FOR(count_requests(true, 0) == 1, LB_IDLE_MS + 1000), "run not uploaded");
+    int64_t waited = esp_timer_get_time() - idle;
+    CHECK(waited >= LB_IDLE_MS * 1000LL, "radio on after only %lld us in the menu", (long long) waited);
+    CHECK(WAIT_FOR(leaderboard_top(&top), 1000), "top scores not fetched");
+    CHECK(top.count == 2 && top.entries[0].score == 120 && !strcmp(top.entries[1].name, "Bob"), "wrong top scores");
+    CHECK(WAIT_FOR(!atomic_load(&radio_on), 1000) && stored_runs() == 0, "sync didn't finish");
+    
+    // Failed uploads are retried with a doubling delay, and the run is kept until it gets through.
+    start_playing();
+    pthread_mutex_lock(&server_lock);
+    fail_uploads = 3;
+    pthread_mutex_unlock(&server_lock);
+    submit(7);
+    int64_t since = esp_timer_get_time();
+    leaderboard_idle(true);
+    CHECK(WAIT_FOR(count_requests(true, since) == 4, LB_IDLE_MS + 7 * LB_RETRY_MIN_MS + 1000), "upload not retried");
+    CHECK(WAIT_FOR(stored_runs() == 0, 1000), "run not removed after upload");
+    pthread_mutex_lock(&server_lock);
+    int64_t prev_gap = 0;
+    int     retries  = 0;
+    for (int i = 0, last = -1; i < num_requests; i++) {
+        if (!requests[i].upload || requests[i].time < since) continue;
+        if (last >= 0) {
+            int64_t gap = requests[i].time - requests[last].time;
+            int64_t expect = (LB_RETRY_MIN_MS << retries) * 1000LL;
+            CHECK(gap >= expect * 9 / 10, "retry %d after %lld us, expected %lld", retries, (long long) gap, (long long) expect);
+            CHECK(gap > prev_gap, "retry %d didn't back off", retries);
+            prev_gap = gap;
+            retries ++;
+        }
+        last = i;
+    }
+    pthread_mutex_unlock(&server_lock);
+    CHECK(retries == 3, "%d retries", retries);
+    
+    // A server that stops answering costs one timeout per try, and never holds up the game.
+    start_playing();
+    pthread_mutex_lock(&server_lock);
+    delay_ms = LB_TIMEOUT_MS * 5;
+    pthread_mutex_unlock(&server_lock);
+    submit(9);
+    since = esp_timer_get_time();
+    leaderboard_idle(true);
+    CHECK(WAIT_FOR(count_requests(true, since) == 1, LB_IDLE_MS + 1000), "upload not tried");
+    int64_t slowest = 0;
+    for (int i = 0; i < 50; i++) {
+        int64_t start = esp_timer_get_time();
+        leaderboard_top(&top);
+        leaderboard_idle(true);
+        int64_t time = esp_timer_get_time() - start;
+        if (time > slowest) slowest = time;
+        vTaskDelay(2);
+    }
+    CHECK(slowest < MAX_CALL_US, "menu calls took up to %lld us during a hung request", (long long) slowest);
+    CHECK(WAIT_FOR(!atomic_load(&radio_on), LB_TIMEOUT_MS * 2), "radio still on after the timeout");
+    int64_t radio_time = atomic_load(&radio_off_time) - atomic_load(&radio_on_time);
+    CHECK(radio_time < (LB_TIMEOUT_MS + 100) * 1000LL, "hung request kept the radio on for %lld us", (long long) radio_time);
+    submit(10);
+    start_playing();
+    pthread_mutex_lock(&server_lock);
+    delay_ms = 0;
+    pthread_mutex_unlock(&server_lock);
+    since = esp_timer_get_time();
+    leaderboard_idle(true);
+    CHECK(WAIT_FOR(stored_runs() == 0, LB_IDLE_MS + LB_RETRY_MAX_MS + 1000), "runs lost after a timeout");
+    int64_t upload_runs = 0;
+    pthread_mutex_lock(&server_lock);
+    for (int i = 0; i < num_requests; i++) {
+        if (requests[i].upload && requests[i].time >= since) upload_runs += requests[i].runs;
+    }
+    pthread_mutex_unlock(&server_lock);
+    CHECK(upload_runs == 2, "%lld runs uploaded after the timeout", (long long) upload_runs);
+    CHECK(WAIT_FOR(!atomic_load(&radio_on), 1000), "sync didn't finish");
+    
+    // Top scores too large to hold aren't fetched again until the next interval.
+    static char big[LB_BODY_MAX * 2];
+    strcpy(big, "[");
+    while (strlen(big) < LB_BODY_MAX + 100) strcat(big, "{\"name\": \"Padding\", \"score\": 1}, ");
+    strcat(big, "{\"name\": \"Last\", \"score\": 1}]");
+    start_playing();
+    pthread_mutex_lock(&server_lock);
+    top_body = big;
+    top_etag ++;
+    pthread_mutex_unlock(&server_lock);
+    submit(11);
+    since = esp_timer_get_time();
+    leaderboard_idle(true);
+    CHECK(WAIT_FOR(count_requests(false, since) == 1, LB_IDLE_MS + 1000), "top scores not fetched");
+    vTaskDelay(LB_INTERVAL_MS / 2);
+    CHECK(count_requests(false, since) == 1, "oversized top scores fetched %d times", count_requests(false, since));
+    CHECK(!leaderboard_top(&top) && top.count == 2, "oversized top scores replaced the cached ones");
+    
+    return check_report("Leaderboard");
+}
@@ -0,0 +1,116 @@
+
+// Host test of the time from gameplay events to the LEDs.
+
+#include "led.h"
+#include "ws2812.h"
+#include "freertos/task.h"
+#include "check.h"
+#include <pthread.h>
+
+// Maximum time from an event to the LEDs showing it.
+#define MAX_LATENCY_US (LED_FRAME_MS * 1000)
+
+// The last colours sent and when, shared with the LED task.
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static uint8_t         sent[LED_COUNT * 3];
+static int64_t         sent_time;
+static int             num_sent;
+
+esp_err_t ws2812_init(int gpio) {
+    return ESP_OK;
+}
+
+esp_err_t ws2812_send_data(uint8_t *data, int length) {
+    pthread_mutex_lock(&lock);
+    memcpy(sent, data, length);
+    sent_time = esp_timer_get_time();
+    num_sent ++;
+    pthread_mutex_unlock(&lock);
+    return ESP_OK;
+}
+
+typedef bool (*led_cond_t)(const uint8_t *leds);
+
+// Waits until the LEDs show something, returns the time it took or -1 after a timeout.
+static int64_t wait_for(led_cond_t cond, int64_t since, int timeout_ms) {
+    int64_t deadline = since + timeout_ms * 1000LL;
+    while (esp_timer_get_time() < deadline) {
+        pthread_mutex_lock(&lock);
+        bool    met  = cond(sent);
+        int64_t time = sent_time;
+        pthread_mutex_unlock(&lock);
+        if (met && time >= since) return time - since;
+        vTaskDelay(1);
+    }
+    return -1;
+}
+
+// All LEDs lit white, the score flash.
+static bool is_white(const uint8_t *leds) {
+    for (int i = 0; i < LED_COUNT * 3; i++) {
+        if (leds[i] < LED_BRIGHTNESS / 2) return false;
+    }
+    return true;
+}
+
+// All LEDs dark.
+static bool is_dark(const uint8_t *leds) {
+    for (int i = 0; i < LED_COUNT * 3; i++) {
+        if (leds[i]) return false;
+    }
+    return true;
+}
+
+// The first LED red and the last dark, the start of the death sweep.
+static bool is_sweep_start(const uint8_t *leds) {
+    const uint8_t *last = leds + (LED_COUNT - 1) * 3;
+    return leds[1] && !leds[0] && !leds[2] && !last[0] && !last[1] && !last[2];
+}
+
+// Every LED red, the end of the death sweep.
+static bool is_sweep_end(const uint8_t *leds) {
+    for (int i = 0; i < LED_COUNT; i++) {
+        if (!leds[i*3+1] || leds[i*3] || leds[i*3+2]) return false;
+    }
+    return true;
+}
+
+int main() {
+    CHECK(led_init(), "LED task didn't start");
+    vTaskDelay(10);
+    
+    // A score lights the LEDs within a frame, and the flash is over after its duration.
+    int64_t start = esp_timer_get_time();
+    led_event(LED_SCORE, 0);
+    int64_t latency = wait_for(is_white, start, 100);
+    CHECK(latency >= 0 && latency <= MAX_LATENCY_US, "score flash after %lld us", (long long) latency);
+    int64_t dark = wait_for(is_dark, start, LED_FLASH_MS * 2);
+    CHECK(dark >= LED_FLASH_MS * 1000 && dark <= (LED_FLASH_MS + 2 * LED_FRAME_MS) * 1000,
+        "score flash over after %lld us", (long long) dark);
+    
+    // Once dark, the task sleeps instead of sending frames.
+    pthread_mutex_lock(&lock);
+    int idle_sent = num_sent;
+    pthread_mutex_unlock(&lock);
+    vTaskDelay(LED_FRAME_MS * 5);
+    pthread_mutex_lock(&lock);
+    CHECK(num_sent == idle_sent, "%d frames sent while idle", num_sent - idle_sent);
+    pthread_mutex_unlock(&lock);
+    
+    // A death sweeps red from the first LED to the last.
+    start = esp_timer_get_time();
+    led_event(LED_DEATH, 0);
+    latency = wait_for(is_sweep_start, start, 100);
+    CHECK(latency >= 0 && latency <= MAX_LATENCY_US, "death sweep started after %lld us", (long long) latency);
+    int64_t swept = wait_for(is_sweep_end, start, LED_DEATH_MS);
+    CHECK(swept >= 0 && swept <= LED_DEATH_MS * 1000 / 2 + LED_FRAME_MS * 1000,
+        "death sweep reached the last LED after %lld us", (long long) swept);
+    
+    // Ending the game turns them off right away.
+    start = esp_timer_get_time();
+    led_event(LED_OFF, 0);
+    latency = wait_for(is_dark, start, 100);
+    CHECK(latency >= 0 && latency <= MAX_LATENCY_US, "LEDs off after %lld us", (long long) latency);
+    
+    return check_report("LED");
+}
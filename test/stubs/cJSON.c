@@ -0,0 +1,180 @@
+
+#include "cJSON.h"
+#include <ctype.h>
+
+static cJSON *cjson_new(int type) {
+    cJSON *item = calloc(1, sizeof(cJSON));
+    item->type = type;
+    return item;
+}
+
+bool cJSON_AddItemToArray(cJSON *array, cJSON *item) {
+    cJSON **tail = &array->child;
+    while (*tail) tail = &(*tail)->next;
+    *tail = item;
+    return true;
+}
+
+static cJSON *cjson_add(cJSON *object, const char *name, cJSON *item) {
+    item->string = strdup(name);
+    cJSON_AddItemToArray(object, item);
+    return item;
+}
+
+cJSON *cJSON_CreateObject() {
+    return cjson_new(cJSON_Object);
+}
+
+cJSON *cJSON_AddStringToObject(cJSON *object, const char *name, const char *value) {
+    cJSON *item = cjson_new(cJSON_String);
+    item->valuestring = strdup(value);
+    return cjson_add(object, name, item);
+}
+
+cJSON *cJSON_AddNumberToObject(cJSON *object, const char *name, double value) {
+    cJSON *item = cjson_new(cJSON_Number);
+    item->valuedouble = value;
+    return cjson_add(object, name, item);
+}
+
+cJSON *cJSON_AddArrayToObject(cJSON *object, const char *name) {
+    return cjson_add(object, name, cjson_new(cJSON_Array));
+}
+
+// Appends an item to out, which has room for all of it.
+static char *cjson_print(const cJSON *item, char *out) {
+    if (item->string) out += sprintf(out, "\"%s\":", item->string);
+    if (item->type == cJSON_Number) return out + sprintf(out, "%.17g", item->valuedouble);
+    if (item->type == cJSON_String) return out + sprintf(out, "\"%s\"", item->valuestring);
+    *out++ = item->type == cJSON_Array ? '[' : '{';
+    for (const cJSON *child = item->child; child; child = child->next) {
+        out = cjson_print(child, out);
+        if (child->next) *out++ = ',';
+    }
+    *out++ = item->type == cJSON_Array ? ']' : '}';
+    *out   = 0;
+    return out;
+}
+
+// Upper bound of the printed size of an item.
+static size_t cjson_size(const cJSON *item) {
+    size_t size = 32 + (item->string ? strlen(item->string) : 0) + (item->valuestring ? strlen(item->valuestring) : 0);
+    for (const cJSON *child = item->child; child; child = child->next) size += cjson_size(child);
+    return size;
+}
+
+char *cJSON_PrintUnformatted(const cJSON *item) {
+    char *out = malloc(cjson_size(item));
+    cjson_print(item, out);
+    return out;
+}
+
+static const char *cjson_skip(const char *text) {
+    while (text && isspace((unsigned char) *text)) text ++;
+    return text;
+}
+
+// Parses a string without escapes, returns a copy and moves text past it.
+static char *cjson_parse_string(const char **text) {
+    const char *start = *text + 1;
+    const char *end   = strchr(start, '"');
+    if (!end) return NULL;
+    *text = end + 1;
+    return strndup(start, end - start);
+}
+
+static cJSON *cjson_parse_value(const char **text);
+
+// Parses the items of an array or object, moving text past the closing bracket.
+static cJSON *cjson_parse_items(const char **text, int type) {
+    cJSON *item = cjson_new(type);
+    char   close = type == cJSON_Array ? ']' : '}';
+    *text = cjson_skip(*text + 1);
+    if (**text == close) {
+        *text += 1;
+        return item;
+    }
+    while (1) {
+        char *name = NULL;
+        if (type == cJSON_Object) {
+            if (**text != '"' || !(name = cjson_parse_string(text))) break;
+            *text = cjson_skip(*text);
+            if (**text != ':') break;
+            *text = cjson_skip(*text + 1);
+        }
+        cJSON *child = cjson_parse_value(text);
+        if (!child) {
+            free(name);
+            break;
+        }
+        child->string = name;
+        cJSON_AddItemToArray(item, child);
+        *text = cjson_skip(*text);
+        if (**text == ',') {
+            *text = cjson_skip(*text + 1);
+        } else if (**text == close) {
+            *text += 1;
+            return item;
+        } else {
+            break;
+        }
+    }
+    cJSON_Delete(item);
+    return NULL;
+}
+
+static cJSON *cjson_parse_value(const char **text) {
+    *text = cjson_skip(*text);
+    if (**text == '[') return cjson_parse_items(text, cJSON_Array);
+    if (**text == '{') return cjson_parse_items(text, cJSON_Object);
+    if (**text == '"') {
+        char *value = cjson_parse_string(text);
+        if (!value) return NULL;
+        cJSON *item = cjson_new(cJSON_String);
+        item->valuestring = value;
+        return item;
+    }
+    char *end;
+    double value = strtod(*text, &end);
+    if (end == *text) return NULL;
+    *text = end;
+    cJSON *item = cjson_new(cJSON_Number);
+    item->valuedouble = value;
+    return item;
+}
+
+cJSON *cJSON_Parse(const char *text) {
+    cJSON *item = cjson_parse_value(&text);
+    if (item && *cjson_skip(text)) {
+        cJSON_Delete(item);
+        return NULL;
+    }
+    return item;
+}
+
+cJSON *cJSON_GetObjectItem(const cJSON *object, const char *name) {
+    if (!object || object->type != cJSON_Object) return NULL;
+    for (cJSON *child = object->child; child; child = child->next) {
+        if (!strcmp(child->string, name)) return child;
+    }
+    return NULL;
+}
+
+bool cJSON_IsString(const cJSON *item) {
+    return item && item->type == cJSON_String;
+}
+
+bool cJSON_IsNumber(const cJSON *item) {
+    return item && item->type == cJSON_Number;
+}
+
+void cJSON_Delete(cJSON *item) {
+    while (item) {
+        cJSON *next = item->next;
+        cJSON_Delete(item->child);
+        free(item->string);
+        free(item->valuestring);
+        free(item);
+        item = next;
+    }
+}
@@ -0,0 +1,32 @@
+#pragma once
+#include "host.h"
+
+// The part of cJSON the game uses: objects, arrays, strings and numbers.
+#define cJSON_Number 1
+#define cJSON_String 2
+#define cJSON_Array  3
+#define cJSON_Object 4
+
+typedef struct cJSON {
+    struct cJSON *next;
+    struct cJSON *child;
+    int           type;
+    char         *valuestring;
+    double        valuedouble;
+    char         *string;
+} cJSON;
+
+#define cJSON_ArrayForEach(element, array) \
+    for (element = (array) ? (array)->child : NULL; element; element = element->next)
+
+cJSON *cJSON_CreateObject     ();
+cJSON *cJSON_AddStringToObject(cJSON *object, const char *name, const char *value);
+cJSON *cJSON_AddNumberToObject(cJSON *object, const char *name, double value);
+cJSON *cJSON_AddArrayToObject (cJSON *object, const char *name);
+bool   cJSON_AddItemToArray   (cJSON *array, cJSON *item);
+char  *cJSON_PrintUnformatted (const cJSON *item);
+cJSON *cJSON_Parse            (const char *text);
+cJSON *cJSON_GetObjectItem    (const cJSON *object, const char *name);
+bool   cJSON_IsString         (const cJSON *item);
+bool   cJSON_IsNumber         (const cJSON *item);
+void   cJSON_Delete           (cJSON *item);
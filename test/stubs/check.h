@@ -0,0 +1,28 @@
+
+#pragma once
+
+// Shared by the host tests: checks that count failures instead of stopping at the first one.
+
+#include <stdio.h>
+
+// Number of checks that failed so far.
+static int failures;
+
+// Counts a failure and prints the message if the condition doesn't hold.
+#define CHECK(cond, ...) do {\
+        if (!(cond)) {\
+            fprintf(stderr, __VA_ARGS__);\
+            fprintf(stderr, "\n");\
+            failures ++;\
+        }\
+    } while (0)
+
+// Prints the result of the checks, returns the test's exit status.
+static inline int check_report(const char *name) {
+    if (failures) {
+        fprintf(stderr, "%d checks failed\n", failures);
+        return 1;
+    }
+    printf("%s checks passed.\n", name);
+    return 0;
+}
@@ -0,0 +1,12 @@
+#pragma once
+#include "host.h"
+
+#define GPIO_MODE_OUTPUT 2
+
+static inline esp_err_t gpio_set_direction(int gpio, int mode) {
+    return ESP_OK;
+}
+
+static inline esp_err_t gpio_set_level(int gpio, uint32_t level) {
+    return ESP_OK;
+}
@@ -0,0 +1,5 @@
+#pragma once
+#include "host.h"
+
+// Plain HTTP on the host, there is nothing to attach.
+#define esp_crt_bundle_attach NULL
@@ -0,0 +1,146 @@
+
+#include "esp_http_client.h"
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <strings.h>
+#include <errno.h>
+
+int host_http_port;
+
+struct esp_http_client {
+    esp_http_client_config_t config;
+    char        path[128];
+    char        headers[512];
+    const char *post;
+    int         post_len;
+    int         fd;
+    int         status;
+    // Bytes received past the headers, not read yet.
+    char        buf[4096];
+    int         buf_len, buf_pos;
+    // Bytes of body left, -1 if unknown.
+    int         body_left;
+};
+
+esp_http_client_handle_t esp_http_client_init(const esp_http_client_config_t *config) {
+    struct esp_http_client *client = calloc(1, sizeof(struct esp_http_client));
+    client->config = *config;
+    client->fd     = -1;
+    // Keep only the path, the host is always the test's server.
+    const char *path = strstr(config->url, "://");
+    path = path ? strchr(path + 3, '/') : NULL;
+    snprintf(client->path, sizeof(client->path), "%s", path ? path : "/");
+    return client;
+}
+
+esp_err_t esp_http_client_set_header(esp_http_client_handle_t client, const char *key, const char *value) {
+    size_t len = strlen(client->headers);
+    snprintf(client->headers + len, sizeof(client->headers) - len, "%s: %s\r\n", key, value);
+    return ESP_OK;
+}
+
+esp_err_t esp_http_client_set_post_field(esp_http_client_handle_t client, const char *data, int len) {
+    client->post     = data;
+    client->post_len = len;
+    return ESP_OK;
+}
+
+// Connects and sends the request line and headers.
+esp_err_t esp_http_client_open(esp_http_client_handle_t client, int write_len) {
+    client->fd = socket(AF_INET, SOCK_STREAM, 0);
+    struct timeval tv = {
+        .tv_sec  = client->config.timeout_ms / 1000,
+        .tv_usec = client->config.timeout_ms % 1000 * 1000,
+    };
+    setsockopt(client->fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    setsockopt(client->fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_port   = htons(host_http_port),
+    };
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (connect(client->fd, (struct sockaddr *) &addr, sizeof(addr))) return ESP_ERR_HTTP_CONNECT;
+    
+    char head[1024];
+    int len = snprintf(head, sizeof(head), "%s %s HTTP/1.1\r\nHost: test\r\nConnection: close\r\nContent-Length: %d\r\n%s\r\n",
+        client->config.method == HTTP_METHOD_POST ? "POST" : "GET", client->path, write_len, client->headers);
+    if (send(client->fd, head, len, MSG_NOSIGNAL) != len) return ESP_FAIL;
+    return ESP_OK;
+}
+
+// Reads the status line and headers, returns the content length or -1.
+int esp_http_client_fetch_headers(esp_http_client_handle_t client) {
+    // Read until the end of the headers.
+    char *end = NULL;
+    while (!end) {
+        if (client->buf_len == sizeof(client->buf) - 1) return -1;
+        int got = recv(client->fd, client->buf + client->buf_len, sizeof(client->buf) - 1 - client->buf_len, 0);
+        if (got <= 0) return -1;
+        client->buf_len += got;
+        client->buf[client->buf_len] = 0;
+        end = strstr(client->buf, "\r\n\r\n");
+    }
+    *end = 0;
+    client->buf_pos   = end + 4 - client->buf;
+    client->body_left = -1;
+    
+    char *save;
+    char *line = strtok_r(client->buf, "\r\n", &save);
+    if (!line || sscanf(line, "HTTP/%*s %d", &client->status) != 1) return -1;
+    while ((line = strtok_r(NULL, "\r\n", &save))) {
+        char *colon = strchr(line, ':');
+        if (!colon) continue;
+        *colon = 0;
+        char *value = colon + 1;
+        while (*value == ' ') value ++;
+        if (!strcasecmp(line, "Content-Length")) client->body_left = atoi(value);
+        esp_http_client_event_t event = {
+            .event_id     = HTTP_EVENT_ON_HEADER,
+            .header_key   = line,
+            .header_value = value,
+        };
+        if (client->config.event_handler) client->config.event_handler(&event);
+    }
+    return client->body_left < 0 ? 0 : client->body_left;
+}
+
+int esp_http_client_read(esp_http_client_handle_t client, char *buffer, int len) {
+    if (client->body_left >= 0 && len > client->body_left) len = client->body_left;
+    if (len <= 0) return 0;
+    int got;
+    if (client->buf_pos < client->buf_len) {
+        got = client->buf_len - client->buf_pos < len ? client->buf_len - client->buf_pos : len;
+        memcpy(buffer, client->buf + client->buf_pos, got);
+        client->buf_pos += got;
+    } else {
+        got = recv(client->fd, buffer, len, 0);
+        if (got < 0) return -1;
+    }
+    if (client->body_left >= 0) client->body_left -= got;
+    return got;
+}
+
+esp_err_t esp_http_client_perform(esp_http_client_handle_t client) {
+    esp_err_t res = esp_http_client_open(client, client->post_len);
+    if (res) return res;
+    if (client->post_len && send(client->fd, client->post, client->post_len, MSG_NOSIGNAL) != client->post_len) {
+        return errno == EAGAIN ? ESP_ERR_TIMEOUT : ESP_FAIL;
+    }
+    if (esp_http_client_fetch_headers(client) < 0) return errno == EAGAIN ? ESP_ERR_TIMEOUT : ESP_FAIL;
+    char discard[256];
+    int got;
+    while ((got = esp_http_client_read(client, discard, sizeof(discard))) > 0);
+    return got < 0 ? ESP_FAIL : ESP_OK;
+}
+
+int esp_http_client_get_status_code(esp_http_client_handle_t client) {
+    return client->status;
+}
+
+esp_err_t esp_http_client_cleanup(esp_http_client_handle_t client) {
+    if (client->fd >= 0) close(client->fd);
+    free(client);
+    return ESP_OK;
+}
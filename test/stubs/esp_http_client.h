@@ -0,0 +1,45 @@
+#pragma once
+#include "host.h"
+
+// Plain HTTP over a socket to 127.0.0.1:host_http_port, whatever host the URL names.
+extern int host_http_port;
+
+#define ESP_ERR_HTTP_CONNECT 0x7002
+#define ESP_ERR_TIMEOUT      0x107
+
+typedef struct esp_http_client *esp_http_client_handle_t;
+
+typedef enum {
+    HTTP_METHOD_GET,
+    HTTP_METHOD_POST,
+} esp_http_client_method_t;
+
+typedef enum {
+    HTTP_EVENT_ON_HEADER,
+} esp_http_client_event_id_t;
+
+typedef struct {
+    esp_http_client_event_id_t event_id;
+    char                      *header_key;
+    char                      *header_value;
+} esp_http_client_event_t;
+
+typedef esp_err_t (*http_event_handle_cb)(esp_http_client_event_t *event);
+
+typedef struct {
+    const char              *url;
+    esp_http_client_method_t method;
+    int                      timeout_ms;
+    http_event_handle_cb     event_handler;
+    esp_err_t              (*crt_bundle_attach)(void *conf);
+} esp_http_client_config_t;
+
+esp_http_client_handle_t esp_http_client_init           (const esp_http_client_config_t *config);
+esp_err_t                esp_http_client_set_header     (esp_http_client_handle_t client, const char *key, const char *value);
+esp_err_t                esp_http_client_set_post_field (esp_http_client_handle_t client, const char *data, int len);
+esp_err_t                esp_http_client_perform        (esp_http_client_handle_t client);
+esp_err_t                esp_http_client_open           (esp_http_client_handle_t client, int write_len);
+int                      esp_http_client_fetch_headers  (esp_http_client_handle_t client);
+int                      esp_http_client_read           (esp_http_client_handle_t client, char *buffer, int len);
+int                      esp_http_client_get_status_code(esp_http_client_handle_t client);
+esp_err_t                esp_http_client_cleanup        (esp_http_client_handle_t client);
@@ -0,0 +1,5 @@
+#pragma once
+#include "host.h"
+
+// Same CRC-32 as the ROM's little endian one.
+uint32_t esp_rom_crc32_le(uint32_t crc, const uint8_t *buf, uint32_t len);
@@ -0,0 +1,163 @@
+
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include <pthread.h>
+#include <errno.h>
+#include <time.h>
+
+struct host_task {
+    pthread_t       thread;
+    TaskFunction_t  fn;
+    void           *args;
+    pthread_mutex_t lock;
+    pthread_cond_t  cond;
+    uint32_t        notified;
+};
+
+struct host_queue {
+    pthread_mutex_t lock;
+    pthread_cond_t  cond;
+    size_t          length, size, head, count;
+    uint8_t        *items;
+};
+
+static __thread struct host_task *current;
+
+// Converts a wait in ticks to an absolute deadline.
+static void host_deadline(struct timespec *ts, TickType_t wait) {
+    clock_gettime(CLOCK_REALTIME, ts);
+    ts->tv_sec  += wait / 1000;
+    ts->tv_nsec += (wait % 1000) * 1000000L;
+    if (ts->tv_nsec >= 1000000000L) {
+        ts->tv_sec  ++;
+        ts->tv_nsec -= 1000000000L;
+    }
+}
+
+// Waits on cond until woken or the wait runs out, returns false on timeout.
+static bool host_wait(pthread_cond_t *cond, pthread_mutex_t *lock, TickType_t wait) {
+    if (wait == 0) return false;
+    if (wait == portMAX_DELAY) return !pthread_cond_wait(cond, lock);
+    struct timespec ts;
+    host_deadline(&ts, wait);
+    return pthread_cond_timedwait(cond, lock, &ts) != ETIMEDOUT;
+}
+
+static void *host_task_main(void *arg) {
+    current = arg;
+    current->fn(current->args);
+    return NULL;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char *name, uint32_t stack, void *args, UBaseType_t prio, TaskHandle_t *handle, BaseType_t core) {
+    struct host_task *task = calloc(1, sizeof(struct host_task));
+    task->fn   = fn;
+    task->args = args;
+    pthread_mutex_init(&task->lock, NULL);
+    pthread_cond_init(&task->cond, NULL);
+    if (handle) *handle = task;
+    if (pthread_create(&task->thread, NULL, host_task_main, task)) return pdFAIL;
+    pthread_detach(task->thread);
+    return pdPASS;
+}
+
+void vTaskDelete(TaskHandle_t task) {
+    if (!task || task == current) pthread_exit(NULL);
+    pthread_cancel(task->thread);
+}
+
+void vTaskDelay(TickType_t ticks) {
+    struct timespec ts = { .tv_sec = ticks / 1000, .tv_nsec = (ticks % 1000) * 1000000L };
+    nanosleep(&ts, NULL);
+}
+
+TickType_t xTaskGetTickCount() {
+    return esp_timer_get_time() / 1000;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t wait) {
+    struct host_task *task = current;
+    pthread_mutex_lock(&task->lock);
+    while (!task->notified && host_wait(&task->cond, &task->lock, wait));
+    uint32_t value = task->notified;
+    if (value) task->notified = clear ? 0 : value - 1;
+    pthread_mutex_unlock(&task->lock);
+    return value;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+    pthread_mutex_lock(&task->lock);
+    task->notified ++;
+    pthread_cond_broadcast(&task->cond);
+    pthread_mutex_unlock(&task->lock);
+    return pdPASS;
+}
+
+UBaseType_t uxTaskPriorityGet(TaskHandle_t task) {
+    return tskIDLE_PRIORITY + 1;
+}
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t size) {
+    struct host_queue *queue = calloc(1, sizeof(struct host_queue));
+    pthread_mutex_init(&queue->lock, NULL);
+    pthread_cond_init(&queue->cond, NULL);
+    queue->length = length;
+    queue->size   = size;
+    queue->items  = calloc(length, size ? size : 1);
+    return queue;
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t wait) {
+    pthread_mutex_lock(&queue->lock);
+    while (queue->count == queue->length && host_wait(&queue->cond, &queue->lock, wait));
+    bool ok = queue->count < queue->length;
+    if (ok) {
+        if (queue->size) memcpy(queue->items + (queue->head + queue->count) % queue->length * queue->size, item, queue->size);
+        queue->count ++;
+        pthread_cond_broadcast(&queue->cond);
+    }
+    pthread_mutex_unlock(&queue->lock);
+    return ok;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t wait) {
+    pthread_mutex_lock(&queue->lock);
+    while (!queue->count && host_wait(&queue->cond, &queue->lock, wait));
+    bool ok = queue->count > 0;
+    if (ok) {
+        if (queue->size) memcpy(item, queue->items + queue->head * queue->size, queue->size);
+        queue->head = (queue->head + 1) % queue->length;
+        queue->count --;
+        pthread_cond_broadcast(&queue->cond);
+    }
+    pthread_mutex_unlock(&queue->lock);
+    return ok;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue) {
+    pthread_mutex_lock(&queue->lock);
+    UBaseType_t count = queue->count;
+    pthread_mutex_unlock(&queue->lock);
+    return count;
+}
+
+// A mutex is a queue of one empty item that starts full.
+SemaphoreHandle_t xSemaphoreCreateMutex() {
+    SemaphoreHandle_t sem = xQueueCreate(1, 0);
+    xQueueSend(sem, NULL, 0);
+    return sem;
+}
+
+// A binary semaphore starts empty.
+SemaphoreHandle_t xSemaphoreCreateBinary() {
+    return xQueueCreate(1, 0);
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t wait) {
+    return xQueueReceive(sem, NULL, wait);
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem) {
+    return xQueueSend(sem, NULL, 0);
+}
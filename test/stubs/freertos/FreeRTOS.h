@@ -0,0 +1,21 @@
+#pragma once
+#include "host.h"
+
+// FreeRTOS on pthreads, one tick is a millisecond.
+typedef uint32_t TickType_t;
+typedef int      BaseType_t;
+typedef unsigned UBaseType_t;
+typedef struct host_task  *TaskHandle_t;
+typedef struct host_queue *QueueHandle_t;
+typedef struct host_queue *SemaphoreHandle_t;
+typedef QueueHandle_t xQueueHandle;
+
+#define portMAX_DELAY    0xffffffff
+#define pdTRUE           1
+#define pdFALSE          0
+#define pdPASS           1
+#define pdFAIL           0
+#define pdMS_TO_TICKS(x) (x)
+#define portTICK_PERIOD_MS 1
+#define tskIDLE_PRIORITY 0
+#define configMAX_PRIORITIES 25
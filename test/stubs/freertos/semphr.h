@@ -0,0 +1,7 @@
+#pragma once
+#include "queue.h"
+
+SemaphoreHandle_t xSemaphoreCreateMutex();
+SemaphoreHandle_t xSemaphoreCreateBinary();
+BaseType_t        xSemaphoreTake(SemaphoreHandle_t sem, TickType_t wait);
+BaseType_t        xSemaphoreGive(SemaphoreHandle_t sem);
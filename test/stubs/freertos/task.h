@@ -0,0 +1,12 @@
+#pragma once
+#include "FreeRTOS.h"
+
+typedef void (*TaskFunction_t)(void *);
+
+BaseType_t   xTaskCreatePinnedToCore(TaskFunction_t fn, const char *name, uint32_t stack, void *args, UBaseType_t prio, TaskHandle_t *handle, BaseType_t core);
+void         vTaskDelete            (TaskHandle_t task);
+void         vTaskDelay             (TickType_t ticks);
+TickType_t   xTaskGetTickCount      ();
+uint32_t     ulTaskNotifyTake       (BaseType_t clear, TickType_t wait);
+BaseType_t   xTaskNotifyGive        (TaskHandle_t task);
+UBaseType_t  uxTaskPriorityGet      (TaskHandle_t task);
@@ -0,0 +1,5 @@
+#pragma once
+#include "host.h"
+
+#define GPIO_LED_DATA   5
+#define GPIO_LED_ENABLE 19
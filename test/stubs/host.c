@@ -0,0 +1,36 @@
+
+#include "host.h"
+#include <time.h>
+#include <stdarg.h>
+
+void host_log(char level, const char *tag, const char *fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    fprintf(stderr, "%c %s: ", level, tag);
+    vfprintf(stderr, fmt, args);
+    fprintf(stderr, "\n");
+    va_end(args);
+}
+
+uint32_t esp_random() {
+    return ((uint32_t) rand() << 16) ^ (uint32_t) rand();
+}
+
+int64_t esp_timer_get_time() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000LL + ts.tv_nsec / 1000;
+}
+
+const char *esp_err_to_name(esp_err_t err) {
+    return err ? "ESP_FAIL" : "ESP_OK";
+}
+
+uint32_t esp_rom_crc32_le(uint32_t crc, const uint8_t *buf, uint32_t len) {
+    crc = ~crc;
+    while (len--) {
+        crc ^= *buf++;
+        for (int i = 0; i < 8; i++) crc = (crc >> 1) ^ (0xedb88320 & -(crc & 1));
+    }
+    return ~crc;
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+// Just enough of ESP-IDF for the game's portable modules to build on the host.
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+typedef int esp_err_t;
+#define ESP_OK   0
+#define ESP_FAIL -1
+
+// Every level is checked like printf, including the ones that are compiled out.
+void host_log(char level, const char *tag, const char *fmt, ...) __attribute__((format(printf, 3, 4)));
+static inline void host_log_off(const char *tag, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+static inline void host_log_off(const char *tag, const char *fmt, ...) {}
+
+#define ESP_LOGE(tag, fmt, ...) host_log('E', tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGW(tag, fmt, ...) host_log('W', tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGI(tag, fmt, ...) host_log('I', tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGD(tag, fmt, ...) host_log_off(tag, fmt, ##__VA_ARGS__)
+
+uint32_t    esp_random();
+int64_t     esp_timer_get_time();
+const char *esp_err_to_name(esp_err_t err);
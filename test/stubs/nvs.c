@@ -0,0 +1,74 @@
+
+#include "nvs.h"
+#include <pthread.h>
+#include <time.h>
+
+// Maximum number of keys.
+#define HOST_NVS_KEYS 16
+
+typedef struct {
+    char   key[16];
+    void  *value;
+    size_t size;
+} host_nvs_entry_t;
+
+static pthread_mutex_t  lock = PTHREAD_MUTEX_INITIALIZER;
+static host_nvs_entry_t entries[HOST_NVS_KEYS];
+
+// Finds a key, or a free entry for it if create is set.
+static host_nvs_entry_t *host_nvs_find(const char *key, bool create) {
+    for (int i = 0; i < HOST_NVS_KEYS; i++) {
+        if (entries[i].value && !strcmp(entries[i].key, key)) return &entries[i];
+    }
+    for (int i = 0; create && i < HOST_NVS_KEYS; i++) {
+        if (!entries[i].value) return &entries[i];
+    }
+    return NULL;
+}
+
+esp_err_t nvs_open(const char *name, nvs_open_mode_t mode, nvs_handle_t *handle) {
+    // Only the game's own namespace exists.
+    return ESP_ERR_NVS_NOT_FOUND;
+}
+
+void nvs_close(nvs_handle_t handle) {
+}
+
+esp_err_t nvs_get_blob(nvs_handle_t handle, const char *key, void *out, size_t *size) {
+    pthread_mutex_lock(&lock);
+    host_nvs_entry_t *entry = host_nvs_find(key, false);
+    esp_err_t res = ESP_ERR_NVS_NOT_FOUND;
+    if (entry && *size >= entry->size) {
+        memcpy(out, entry->value, entry->size);
+        *size = entry->size;
+        res   = ESP_OK;
+    } else if (entry) {
+        res = ESP_FAIL;
+    }
+    pthread_mutex_unlock(&lock);
+    return res;
+}
+
+esp_err_t nvs_set_blob(nvs_handle_t handle, const char *key, const void *value, size_t size) {
+    pthread_mutex_lock(&lock);
+    host_nvs_entry_t *entry = host_nvs_find(key, true);
+    if (entry) {
+        free(entry->value);
+        strncpy(entry->key, key, sizeof(entry->key) - 1);
+        entry->value = malloc(size ? size : 1);
+        entry->size  = size;
+        memcpy(entry->value, value, size);
+    }
+    pthread_mutex_unlock(&lock);
+    return entry ? ESP_OK : ESP_FAIL;
+}
+
+esp_err_t nvs_get_str(nvs_handle_t handle, const char *key, char *out, size_t *size) {
+    return ESP_ERR_NVS_NOT_FOUND;
+}
+
+esp_err_t nvs_commit(nvs_handle_t handle) {
+    struct timespec ts = { .tv_nsec = HOST_NVS_COMMIT_MS * 1000000L };
+    nanosleep(&ts, NULL);
+    return ESP_OK;
+}
@@ -0,0 +1,17 @@
+#pragma once
+#include "host.h"
+
+// NVS in RAM, commits are slow like on flash so callers that commit show up in timings.
+typedef uint32_t nvs_handle_t;
+typedef enum { NVS_READONLY, NVS_READWRITE } nvs_open_mode_t;
+
+#define ESP_ERR_NVS_NOT_FOUND 0x1102
+// Time a commit takes.
+#define HOST_NVS_COMMIT_MS    10
+
+esp_err_t nvs_open    (const char *name, nvs_open_mode_t mode, nvs_handle_t *handle);
+void      nvs_close   (nvs_handle_t handle);
+esp_err_t nvs_get_blob(nvs_handle_t handle, const char *key, void *out, size_t *size);
+esp_err_t nvs_set_blob(nvs_handle_t handle, const char *key, const void *value, size_t size);
+esp_err_t nvs_get_str (nvs_handle_t handle, const char *key, char *out, size_t *size);
+esp_err_t nvs_commit  (nvs_handle_t handle);
@@ -0,0 +1,8 @@
+#pragma once
+#include "host.h"
+
+// Types only, host tests don't draw.
+typedef uint32_t pax_col_t;
+typedef enum { PAX_BUF_16_565RGB, PAX_BUF_32_8888ARGB } pax_buf_type_t;
+typedef struct { pax_buf_type_t type; void *buf; int width, height; } pax_buf_t;
+typedef struct pax_font pax_font_t;
@@ -0,0 +1,7 @@
+#pragma once
+#include "host.h"
+
+// Defined by the test, which watches the radio.
+void wifi_init();
+bool wifi_connect_to_stored();
+void wifi_disconnect_and_disable();
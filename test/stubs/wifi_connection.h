@@ -0,0 +1,2 @@
+#pragma once
+#include "wifi_connect.h"
@@ -0,0 +1,6 @@
+#pragma once
+#include "host.h"
+
+// Defined by the test, which watches what is sent.
+esp_err_t ws2812_init(int gpio);
+esp_err_t ws2812_send_data(uint8_t *data, int length);
@@ -0,0 +1,73 @@
+
+// Host test of telemetry sessions as written by the writer task.
+
+#include "telemetry.h"
+#include "quality.h"
+#include "freertos/task.h"
+#include "sys/stat.h"
+#include "check.h"
+
+// The test's directory is always there.
+bool storage_ready() {
+    return true;
+}
+
+// Number of frames in each session, the first outpaces the writer.
+static const int session_frames[] = { TELEMETRY_RING * 4, TELEMETRY_BATCH * 3 + 17 };
+static const int num_sessions     = sizeof(session_frames) / sizeof(int);
+
+// Plays a session, yielding every few frames if paced.
+static void play_session(int frames, bool paced) {
+    frame_t frame = {0};
+    telemetry_start();
+    for (int i = 0; i < frames; i++) {
+        frame.bard.score = i;
+        telemetry_frame(&frame, FRAME_TARGET_US);
+        if (paced && i % 8 == 0) vTaskDelay(1);
+    }
+    telemetry_end();
+}
+
+int main() {
+    mkdir(STORAGE_PATH, 0777);
+    mkdir(STORAGE_DIR, 0777);
+    remove(TELEMETRY_PATH);
+    CHECK(telemetry_init(), "writer task didn't start");
+    
+    // Leaving right after a session must find it written.
+    for (int i = 0; i < num_sessions; i++) {
+        play_session(session_frames[i], i > 0);
+        CHECK(telemetry_wait(1000), "session %d not closed in time", i);
+    }
+    
+    // Each header holds the records its own session dropped, so records and drops add up to its frames.
+    FILE *fd = fopen(TELEMETRY_PATH, "rb");
+    CHECK(fd, "no telemetry written");
+    if (fd) {
+        for (int i = 0; i < num_sessions; i++) {
+            telemetry_header_t header;
+            if (fread(&header, sizeof(header), 1, fd) != 1 || header.magic != TELEMETRY_MAGIC) {
+                CHECK(false, "session %d missing", i);
+                break;
+            }
+            CHECK(header.version == TELEMETRY_VERSION, "session %d version %d", i, header.version);
+            int records = 0;
+            int last    = -1;
+            telemetry_record_t record;
+            while (records + header.dropped < (uint32_t) session_frames[i]
+                    && fread(&record, sizeof(record), 1, fd) == 1) {
+                CHECK((int) record.frame > last, "session %d frame %u out of order", i, record.frame);
+                last = record.frame;
+                records ++;
+            }
+            printf("Session %d: %d records, %u dropped.\n", i, records, header.dropped);
+            CHECK(records + header.dropped == (uint32_t) session_frames[i],
+                "session %d: %d records and %u dropped of %d frames", i, records, header.dropped, session_frames[i]);
+        }
+        uint8_t extra;
+        CHECK(fread(&extra, 1, 1, fd) == 0, "data after the last session");
+        fclose(fd);
+    }
+    
+    return check_report("Telemetry");
+}
@@ -0,0 +1,58 @@
+#!/usr/bin/env python3
+
+import argparse, json
+
+parser = argparse.ArgumentParser(description='Generates the game tuning header from a JSON tuning table')
+parser.add_argument("input", help="Tuning table (JSON)")
+parser.add_argument("output", help="Header to generate")
+args = parser.parse_args()
+
+with open(args.input) as f:
+    table = json.load(f)
+
+def literal(kind, value):
+    if kind == "int":
+        return str(int(value))
+    if kind == "float":
+        # Float suffix keeps the game loop in single precision.
+        return repr(float(value)) + "f"
+    raise ValueError("Unknown type " + kind)
+
+values = {}
+lines  = [
+    "",
+    "// Generated from tuning.json by tools/gen_tuning.py, do not edit.",
+    "",
+    "#pragma once",
+    "",
+]
+for const in table["constants"]:
+    values[const["name"]] = const["value"]
+    lines.append("// " + const["doc"])
+    lines.append("#define {} ({})".format(const["name"], literal(const["type"], const["value"])))
+lines.append("")
+
+# Difficulty curve: every step moves the gap and distance a part of the way to their minimum.
+steps = table["difficulty_steps"]
+def curve(initial, minimum):
+    out, cur = [], float(initial)
+    for i in range(steps):
+        out.append(cur)
+        cur += (minimum - cur) * values["DIFF_FACTOR"]
+    return out
+
+def table_of(name, doc, data):
+    lines.append("// " + doc)
+    lines.append("static const float {}[DIFF_STEPS] = {{".format(name))
+    for i in range(0, len(data), 4):
+        lines.append("    " + " ".join("{:.6f}f,".format(x) for x in data[i:i+4]))
+    lines.append("};")
+
+lines.append("// Number of precomputed difficulty steps, the last one repeats.")
+lines.append("#define DIFF_STEPS ({})".format(steps))
+table_of("diff_pole_gap",  "Pole gap per difficulty step.",      curve(values["INITIAL_POLE_GAP"],  values["MIN_POLE_GAP"]))
+table_of("diff_pole_dist", "Pole distance per difficulty step.", curve(values["INITIAL_POLE_DIST"], values["MIN_POLE_DIST"]))
+lines.append("")
+
+with open(args.output, "w") as f:
+    f.write("\n".join(lines))
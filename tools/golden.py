@@ -0,0 +1,52 @@
+#!/usr/bin/env python3
+
+import argparse, os, re, sys
+
+# Lines that render_check logs and writes to golden.txt on the locfd partition.
+HASHES = re.compile(r"(\w+): \.golden = \{ ((?:0x[0-9a-f]{8}, )+)\}")
+# A scene in the table in main/rendercheck.c, with or without golden hashes.
+SCENE  = re.compile(r'^(    \{ \.name = "(\w+)",[^{}\n]*?)(?:, \.golden = \{[^}]*\})? \},$', re.M)
+# Hashes per line in the table.
+PER_LINE = 5
+
+default_source = os.path.join(os.path.dirname(__file__), "..", "main", "rendercheck.c")
+parser = argparse.ArgumentParser(description="Records the render check's golden band hashes from a badge run")
+parser.add_argument("input", nargs="+", help="Monitor log of a render check, or golden.txt copied from the badge")
+parser.add_argument("--source", default=default_source, help="Source file with the scene table")
+args = parser.parse_args()
+
+# The last run in the input wins.
+recorded = {}
+for path in args.input:
+    with open(path, errors="replace") as f:
+        for name, hashes in HASHES.findall(f.read()):
+            recorded[name] = hashes.rstrip(", ").split(", ")
+if not recorded:
+    sys.exit("No render check hashes in the input")
+if len(set(len(hashes) for hashes in recorded.values())) != 1:
+    sys.exit("Scenes have different numbers of bands, is the input from more than one build?")
+
+with open(args.source) as f:
+    source = f.read()
+
+found = set()
+def record(match):
+    prefix, name = match.group(1), match.group(2)
+    if name not in recorded:
+        print("{}: not in the input, left as it was".format(name))
+        return match.group(0)
+    found.add(name)
+    hashes  = recorded[name]
+    lines   = [", ".join(hashes[i:i + PER_LINE]) + "," for i in range(0, len(hashes), PER_LINE)]
+    body    = "".join("        " + line + "\n" for line in lines)
+    return "{}, .golden = {{\n{}    }} }},".format(prefix, body)
+
+source = SCENE.sub(record, source)
+for name in sorted(set(recorded) - found):
+    print("{}: not in the scene table, ignored".format(name))
+if not found:
+    sys.exit("None of the recorded scenes are in {}".format(args.source))
+
+with open(args.source, "w") as f:
+    f.write(source)
+print("Recorded {} of {} scenes in {}".format(len(found), len(SCENE.findall(source)), args.source))
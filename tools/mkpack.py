@@ -0,0 +1,112 @@
+#!/usr/bin/env python3
+
+import argparse, os, struct, zlib
+
+# Must match PACK_* in main/include/resources.h.
+PACK_MAGIC       = 0x4b504246
+PACK_VERSION     = 1
+PACK_NAME_LEN    = 24
+PACK_FORMAT_PNG  = 0
+PACK_FORMAT_ARGB = 1
+
+HEADER = struct.Struct("<IHH")
+ENTRY  = struct.Struct("<{}sIIHHHH".format(PACK_NAME_LEN))
+
+parser = argparse.ArgumentParser(description='Builds a resource pack for the locfd partition')
+parser.add_argument("output", help="Pack to generate")
+parser.add_argument("inputs", nargs="+", help="PNG images, stored under their file name")
+parser.add_argument("--raw", action="store_true", help="Store decoded ARGB8888 pixels, faster to load but larger")
+args = parser.parse_args()
+
+def png_chunks(data):
+    if data[:8] != b"\x89PNG\r\n\x1a\n":
+        raise ValueError("not a PNG")
+    pos = 8
+    while pos < len(data):
+        length, kind = struct.unpack(">I4s", data[pos:pos+8])
+        yield kind, data[pos+8:pos+8+length]
+        pos += 12 + length
+
+def png_size(data):
+    for kind, body in png_chunks(data):
+        if kind == b"IHDR":
+            return struct.unpack(">II", body[:8])
+    raise ValueError("PNG without IHDR")
+
+def paeth(a, b, c):
+    p = a + b - c
+    pa, pb, pc = abs(p - a), abs(p - b), abs(p - c)
+    if pa <= pb and pa <= pc: return a
+    return b if pb <= pc else c
+
+# Decodes 8-bit RGB or RGBA PNGs, others can still be stored as PNG.
+def png_to_argb(data):
+    idat = b""
+    for kind, body in png_chunks(data):
+        if kind == b"IHDR":
+            width, height, depth, color, _, _, interlace = struct.unpack(">IIBBBBB", body)
+        elif kind == b"IDAT":
+            idat += body
+    if depth != 8 or color not in (2, 6) or interlace:
+        raise ValueError("only 8-bit non-interlaced RGB(A) can be stored raw")
+    bpp    = 4 if color == 6 else 3
+    stride = width * bpp
+    raw    = zlib.decompress(idat)
+    prev   = bytearray(stride)
+    out    = bytearray()
+    for y in range(height):
+        kind = raw[y * (stride + 1)]
+        line = bytearray(raw[y * (stride + 1) + 1:(y + 1) * (stride + 1)])
+        for x in range(stride):
+            a = line[x - bpp] if x >= bpp else 0
+            b = prev[x]
+            c = prev[x - bpp] if x >= bpp else 0
+            if   kind == 1: line[x] = (line[x] + a) & 255
+            elif kind == 2: line[x] = (line[x] + b) & 255
+            elif kind == 3: line[x] = (line[x] + (a + b) // 2) & 255
+            elif kind == 4: line[x] = (line[x] + paeth(a, b, c)) & 255
+        for x in range(width):
+            r, g, b = line[x*bpp:x*bpp+3]
+            alpha   = line[x*bpp+3] if bpp == 4 else 255
+            # Little endian 0xAARRGGBB, as pax keeps it in memory.
+            out += bytes((b, g, r, alpha))
+        prev = line
+    return width, height, bytes(out)
+
+entries = []
+for path in args.inputs:
+    name = os.path.basename(path).encode()
+    if len(name) >= PACK_NAME_LEN:
+        raise SystemExit("{}: name longer than {} characters".format(path, PACK_NAME_LEN - 1))
+    with open(path, "rb") as f:
+        data = f.read()
+    if args.raw:
+        width, height, data = png_to_argb(data)
+        fmt = PACK_FORMAT_ARGB
+    else:
+        width, height = png_size(data)
+        fmt = PACK_FORMAT_PNG
+    entries.append((name, fmt, width, height, data))
+
+# The game looks names up with a binary search.
+entries.sort(key=lambda e: e[0])
+for a, b in zip(entries, entries[1:]):
+    if a[0] == b[0]:
+        raise SystemExit("{}: included twice".format(a[0].decode()))
+
+offset = HEADER.size + ENTRY.size * len(entries)
+index, blobs = b"", b""
+for name, fmt, width, height, data in entries:
+    # Keep raw pixels word aligned.
+    pad     = -offset % 4
+    blobs  += bytes(pad)
+    offset += pad
+    index  += ENTRY.pack(name, offset, len(data), fmt, width, height, 0)
+    blobs  += data
+    offset += len(data)
+
+with open(args.output, "wb") as f:
+    f.write(HEADER.pack(PACK_MAGIC, PACK_VERSION, len(entries)))
+    f.write(index)
+    f.write(blobs)
+print("{}: {} resources, {} bytes".format(args.output, len(entries), offset))
@@ -0,0 +1,74 @@
+#!/usr/bin/env python3
+
+import argparse, csv, struct, sys
+
+# Must match telemetry_header_t and telemetry_record_t in main/include/telemetry.h.
+TELEMETRY_MAGIC   = 0x4d544246
+TELEMETRY_VERSION = 2
+TELEMETRY_ALIVE   = 1
+TELEMETRY_PAUSED  = 2
+
+HEADER = struct.Struct("<IHHII")
+RECORD = struct.Struct("<IIffIffBBBB")
+FIELDS = ["session", "frame", "frame_us", "y", "vel", "score", "pole_dist", "pole_gap",
+          "num_poles", "num_particles", "quality", "alive", "paused"]
+
+parser = argparse.ArgumentParser(description='Decodes telemetry.bin from the locfd partition into CSV and summary stats')
+parser.add_argument("input", help="Telemetry file copied from the badge")
+parser.add_argument("-o", "--output", help="CSV file to write, standard output if omitted")
+parser.add_argument("--spike", type=float, default=2, help="Frames over this many times the target count as spikes")
+args = parser.parse_args()
+
+with open(args.input, "rb") as f:
+    data = f.read()
+
+# Split into sessions, each a header followed by records.
+sessions, pos = [], 0
+while pos + HEADER.size <= len(data):
+    magic, version, record_size, target_us, dropped = HEADER.unpack_from(data, pos)
+    if magic != TELEMETRY_MAGIC or version != TELEMETRY_VERSION or record_size != RECORD.size:
+        sys.exit("{}: bad session header at offset {}".format(args.input, pos))
+    pos += HEADER.size
+    records = []
+    while pos + RECORD.size <= len(data) and struct.unpack_from("<I", data, pos)[0] != TELEMETRY_MAGIC:
+        records.append(RECORD.unpack_from(data, pos))
+        pos += RECORD.size
+    sessions.append((target_us, dropped, records))
+
+def percentile(values, part):
+    return values[min(len(values) - 1, int(len(values) * part))]
+
+out = open(args.output, "w", newline="") if args.output else sys.stdout
+writer = csv.writer(out)
+writer.writerow(FIELDS)
+for num, (_, _, records) in enumerate(sessions):
+    for frame, frame_us, y, vel, score, dist, gap, poles, parts, quality, flags in records:
+        writer.writerow([num, frame, frame_us, "%.2f" % y, "%.2f" % vel, score, "%.1f" % dist, "%.1f" % gap,
+                         poles, parts, quality, int(bool(flags & TELEMETRY_ALIVE)), int(bool(flags & TELEMETRY_PAUSED))])
+if args.output:
+    out.close()
+
+# Stats go to standard error so they don't mix with CSV on standard output.
+def log(*args):
+    print(*args, file=sys.stderr)
+
+for num, (target_us, dropped, records) in enumerate(sessions):
+    # The first frame's time includes starting the game.
+    times = sorted(r[1] for r in records[1:])
+    log("Session {}: {} frames, final score {}".format(num, len(records), records[-1][4] if records else 0))
+    if dropped:
+        log("  {} records dropped".format(dropped))
+    if times:
+        spikes = sum(1 for t in times if t > target_us * args.spike)
+        log("  frame time: mean {:.0f} us, p50 {}, p95 {}, p99 {}, max {} us (target {})".format(
+            sum(times) / len(times), percentile(times, 0.5), percentile(times, 0.95),
+            percentile(times, 0.99), times[-1], target_us))
+        log("  spikes over {:.0f} us: {}".format(target_us * args.spike, spikes))
+    # Time spent at each difficulty, to judge the balance.
+    levels = {}
+    for r in records:
+        if r[10] & TELEMETRY_ALIVE and not r[10] & TELEMETRY_PAUSED:
+            key = (round(r[5], 1), round(r[6], 1))
+            levels[key] = levels.get(key, 0) + 1
+    for (dist, gap), frames in sorted(levels.items(), reverse=True):
+        log("  pole_dist {:6.1f} pole_gap {:5.1f}: {} frames".format(dist, gap, frames))